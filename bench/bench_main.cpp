@@ -0,0 +1,385 @@
+// Microbenchmarks for engine primitives and end-to-end runs (not part of the CLI).
+//
+//   cppsolver_bench [--reps N] [--puzzles DIR] [--json PATH|-]
+//                   [--compare BASELINE.json] [--threshold PCT] [--undo]
+//
+// Every reported metric is a cost (lower is better), so --compare flags any
+// metric that grew by more than --threshold percent over the baseline file
+// written by an earlier --json run, and exits with status 1.
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "solver.hpp"
+#include "propagation.hpp"
+#include "scoring.hpp"
+#include "trail.hpp"
+#include "puzzle_reader.hpp"
+#include "timing.hpp"
+
+namespace {
+
+// 17-clue puzzle with a long forced line below the root, so branches of any
+// size can be built by following its solution.
+const char* kDeepPuzzle =
+    "...............3.85..1.2.......5.7.....4...1...9.......5......73..2.1........4...9";
+
+// Metric name -> value, in report order.
+using Metrics = std::vector<std::pair<std::string, double>>;
+
+// Cost of an empty timed region in ticks, subtracted from every sample.
+uint64_t clock_overhead(){
+    uint64_t best = UINT64_MAX;
+    for(int i = 0; i < 1000; ++i){
+        uint64_t t0 = timing::ticks();
+        best = std::min(best, timing::ticks() - t0);
+    }
+    return best;
+}
+
+double median_ns(std::vector<uint64_t>& ticks){
+    if(ticks.empty()) return 0.0;
+    auto mid = ticks.begin() + ticks.size() / 2;
+    std::nth_element(ticks.begin(), mid, ticks.end());
+    return (double)*mid * timing::ns_per_tick();
+}
+
+// A mid-search state of a real puzzle: propagated, still open, with the
+// solution at hand so probes can place digits that do not fail.
+struct Captured {
+    std::string puzzle;
+    std::array<uint8_t, 81> solution{};
+    SolverState S;
+    Trail T;
+};
+
+std::vector<std::string> read_puzzles(const std::string& path){
+    std::vector<std::string> out;
+    MappedFile f;
+    if(!f.open(path)) return out;
+    PuzzleLineReader reader(f.view());
+    PuzzleLine pl;
+    while(reader.next(pl)) out.emplace_back(pl.text);
+    return out;
+}
+
+std::vector<std::string> dataset_files(const std::string& dir){
+    std::vector<std::string> files;
+    std::error_code ec;
+    for(const auto& e : std::filesystem::directory_iterator(dir, ec)){
+        if(e.is_regular_file() && e.path().extension() == ".txt") files.push_back(e.path().string());
+    }
+    std::sort(files.begin(), files.end());
+    return files;
+}
+
+// States after the root propagation and after 1 and 3 guesses along the
+// solution, for every distinct solvable puzzle (at most 16 puzzles).
+std::vector<Captured> capture_states(const std::vector<std::string>& sources){
+    std::vector<std::string> puzzles;
+    std::set<std::string> seen;
+    for(const auto& p : sources){
+        if(puzzles.size() >= 16) break;
+        if(seen.insert(p).second) puzzles.push_back(p);
+    }
+
+    std::vector<Captured> caps;
+    caps.reserve(puzzles.size() * 3);
+    SudokuSolver solver;
+    for(const auto& p : puzzles){
+        if(!solver.solve(p)) continue;
+        for(int guesses : {0, 1, 3}){
+            Captured& c = caps.emplace_back();
+            c.puzzle = p;
+            c.solution = solver.state().cell_value;
+            c.S.trail = &c.T;
+            c.T.reserve(1 << 12);
+            c.S.init_from_puzzle(p);
+            bool ok = propagate(c.S);
+            for(int k = 0; ok && k < guesses && !c.S.is_solved(); ++k){
+                int cell = select_mrv_cell(c.S);
+                ok = place_digit(c.S, cell, c.solution[cell] - 1) && propagate(c.S);
+            }
+            if(!ok || c.S.is_solved()) caps.pop_back();
+        }
+    }
+    // emplace_back may have moved earlier entries: re-point each trail.
+    for(auto& c : caps) c.S.trail = &c.T;
+    return caps;
+}
+
+// Time each primitive on every captured state, `reps` rounds. Mutating
+// probes run from a trail mark and are undone outside the timed region.
+void bench_primitives(std::vector<Captured>& caps, int reps, Metrics& out){
+    const uint64_t overhead = clock_overhead();
+    std::map<std::string, std::vector<uint64_t>> samples;
+    auto record = [&](const char* name, uint64_t dt){
+        samples[name].push_back(dt > overhead ? dt - overhead : 0);
+    };
+
+    for(int r = 0; r < reps; ++r){
+        for(auto& c : caps){
+            SolverState& S = c.S;
+            Trail& T = c.T;
+            const size_t base = T.mark();
+            const int cell = select_mrv_cell(S);
+            const int digit = c.solution[cell] - 1;
+            // A candidate of `cell` that is not the solution digit.
+            const int wrong = __builtin_ctz((unsigned)(S.cell_mask[cell] & ~(1u << digit)));
+
+            uint64_t t0 = timing::ticks();
+            place_digit(S, cell, digit);
+            record("place_digit", timing::ticks() - t0);
+
+            t0 = timing::ticks();
+            propagate(S);
+            record("propagate", timing::ticks() - t0);
+
+            t0 = timing::ticks();
+            T.undo_to(S, base);
+            record("undo_to", timing::ticks() - t0);
+
+            t0 = timing::ticks();
+            eliminate_digit(S, cell, wrong);
+            record("eliminate_digit", timing::ticks() - t0);
+            T.undo_to(S, base);
+
+            t0 = timing::ticks();
+            int picked = select_mrv_cell(S);
+            record("select_mrv_cell", timing::ticks() - t0);
+            (void)picked;
+
+            compute_scarcity(S);
+            t0 = timing::ticks();
+            float score = score_digit(S, cell, digit);
+            record("score_digit", timing::ticks() - t0);
+            (void)score;
+        }
+    }
+
+    // init_from_puzzle resets the state, so it gets a scratch state of its own.
+    SolverState scratch;
+    Trail scratch_trail;
+    scratch.trail = &scratch_trail;
+    for(int r = 0; r < reps; ++r){
+        for(const auto& c : caps){
+            uint64_t t0 = timing::ticks();
+            scratch.init_from_puzzle(c.puzzle);
+            record("init_from_puzzle", timing::ticks() - t0);
+        }
+    }
+
+    for(const char* name : {"init_from_puzzle", "place_digit", "eliminate_digit", "propagate",
+                            "undo_to", "select_mrv_cell", "score_digit"}){
+        out.emplace_back(std::string("primitive.") + name + ".ns", median_ns(samples[name]));
+    }
+}
+
+// Solve every dataset file in repeated passes (at least 3 and 2000 solves):
+// per-puzzle cost of the fastest pass, latency percentiles over all solves.
+void bench_end_to_end(const std::vector<std::string>& files, Metrics& out){
+    for(const auto& path : files){
+        std::vector<std::string> puzzles = read_puzzles(path);
+        if(puzzles.empty()) continue;
+        const size_t passes = std::max<size_t>(3, (2000 + puzzles.size() - 1) / puzzles.size());
+        SudokuSolver solver;
+        timing::LatencyHistogram latency;
+        latency.reserve(passes * puzzles.size());
+        uint64_t best = UINT64_MAX;
+        for(size_t pass = 0; pass < passes; ++pass){
+            uint64_t total = 0;
+            for(const auto& p : puzzles){
+                uint64_t t0 = timing::ticks();
+                solver.solve(p);
+                uint64_t dt = timing::ticks() - t0;
+                total += dt;
+                latency.add(timing::ticks_to_ns(dt));
+            }
+            best = std::min(best, total);
+        }
+        const std::string key = "e2e." + std::filesystem::path(path).filename().string();
+        out.emplace_back(key + ".us_per_puzzle", timing::ticks_to_ns(best) / 1000.0 / puzzles.size());
+        out.emplace_back(key + ".p50_us", latency.percentile(50) / 1000.0);
+        out.emplace_back(key + ".p99_us", latency.percentile(99) / 1000.0);
+    }
+}
+
+// Trail::undo_to cost against branch size. Each branch follows the solution
+// for `depth` guesses (place + propagate), then places one more digit without
+// propagating so the queues hold pending events, as after a contradiction.
+void bench_undo(int reps){
+    SudokuSolver solver;
+    if(!solver.solve(kDeepPuzzle)){
+        std::cerr << "bench puzzle did not solve\n";
+        return;
+    }
+    const auto solution = solver.state().cell_value;
+
+    SolverState S;
+    Trail T;
+    S.trail = &T;
+    T.reserve(1 << 16);
+    S.init_from_puzzle(kDeepPuzzle);
+    propagate(S);
+    const size_t base = T.mark();
+    const uint64_t overhead = clock_overhead();
+
+    std::cout << "undo_to cost vs branch size (" << reps << " reps, clock overhead "
+              << timing::ticks_to_ns(overhead) << " ns subtracted)\n";
+    for(int depth = 0; depth <= 64; depth = depth ? depth * 2 : 1){
+        size_t entries = 0, pending = 0;
+        uint64_t total = 0;
+        bool reached = true;
+        for(int r = 0; r < reps; ++r){
+            for(int k = 0; k < depth; ++k){
+                int c = select_mrv_cell(S);
+                if(c < 0){ reached = false; break; }
+                place_digit(S, c, solution[c] - 1);
+                propagate(S);
+            }
+            int c = select_mrv_cell(S);
+            if(c >= 0) place_digit(S, c, solution[c] - 1);
+            entries = T.mark() - base;
+            pending = S.q_l4.size() + S.q_l1.size() + S.q_lock.size();
+            uint64_t t0 = timing::ticks();
+            T.undo_to(S, base);
+            uint64_t dt = timing::ticks() - t0;
+            total += dt > overhead ? dt - overhead : 0;
+        }
+        std::cout << "  guesses=" << depth
+                  << " trail_entries=" << entries
+                  << " pending_events=" << pending
+                  << " undo_ns=" << (double)timing::ticks_to_ns(total) / reps << "\n";
+        if(!reached) break;
+    }
+}
+
+void write_json(std::ostream& os, const Metrics& m){
+    os << "{\n  \"version\": 1,\n  \"metrics\": {\n";
+    for(size_t i = 0; i < m.size(); ++i){
+        os << "    \"" << m[i].first << "\": " << m[i].second << (i + 1 < m.size() ? ",\n" : "\n");
+    }
+    os << "  }\n}\n";
+}
+
+// Reads the "metrics" object written by write_json (flat "key": number pairs).
+bool read_json(const std::string& path, std::map<std::string, double>& out){
+    std::ifstream in(path);
+    if(!in) return false;
+    std::stringstream ss;
+    ss << in.rdbuf();
+    const std::string text = ss.str();
+    size_t pos = text.find("\"metrics\"");
+    if(pos == std::string::npos) return false;
+    pos = text.find('{', pos);
+    const size_t end = text.find('}', pos);
+    if(pos == std::string::npos || end == std::string::npos) return false;
+    while(true){
+        size_t k0 = text.find('"', pos);
+        if(k0 == std::string::npos || k0 > end) break;
+        size_t k1 = text.find('"', k0 + 1);
+        size_t colon = text.find(':', k1);
+        if(k1 == std::string::npos || colon == std::string::npos || colon > end) return false;
+        char* stop = nullptr;
+        double v = std::strtod(text.c_str() + colon + 1, &stop);
+        out[text.substr(k0 + 1, k1 - k0 - 1)] = v;
+        pos = (size_t)(stop - text.c_str());
+    }
+    return true;
+}
+
+// Prints every metric against the baseline; returns the number of regressions.
+int compare(std::ostream& os, const Metrics& cur, const std::map<std::string, double>& base,
+            double threshold_pct){
+    int regressions = 0;
+    os << "compare (threshold " << threshold_pct << "%)\n";
+    for(const auto& [name, value] : cur){
+        auto it = base.find(name);
+        if(it == base.end()){
+            os << "  " << name << " " << value << " (not in baseline)\n";
+            continue;
+        }
+        double change = it->second > 0.0 ? (value / it->second - 1.0) * 100.0 : 0.0;
+        bool regressed = change > threshold_pct;
+        regressions += regressed;
+        os << "  " << name << " " << it->second << " -> " << value
+                  << " (" << (change >= 0 ? "+" : "") << change << "%)"
+                  << (regressed ? " REGRESSION" : "") << "\n";
+    }
+    return regressions;
+}
+} // namespace
+
+int main(int argc, char** argv){
+    int reps = 2000;
+    std::string puzzle_dir = "puzzles";
+    std::string json_path;
+    std::string baseline_path;
+    double threshold = 10.0;
+    bool undo_scaling = false;
+    for(int i = 1; i < argc; ++i){
+        std::string arg = argv[i];
+        if(arg == "--reps" && i + 1 < argc) reps = std::max(1, std::atoi(argv[++i]));
+        else if(arg == "--puzzles" && i + 1 < argc) puzzle_dir = argv[++i];
+        else if(arg == "--json" && i + 1 < argc) json_path = argv[++i];
+        else if(arg == "--compare" && i + 1 < argc) baseline_path = argv[++i];
+        else if(arg == "--threshold" && i + 1 < argc) threshold = std::atof(argv[++i]);
+        else if(arg == "--undo") undo_scaling = true;
+        else{
+            std::cerr << "usage: cppsolver_bench [--reps N] [--puzzles DIR] [--json PATH|-]"
+                         " [--compare BASELINE.json] [--threshold PCT] [--undo]\n";
+            return 1;
+        }
+    }
+
+    if(undo_scaling){
+        bench_undo(reps);
+        return 0;
+    }
+
+    const std::vector<std::string> files = dataset_files(puzzle_dir);
+    std::vector<std::string> sources{kDeepPuzzle};
+    for(const auto& f : files){
+        for(auto& p : read_puzzles(f)) sources.push_back(std::move(p));
+    }
+
+    timing::ns_per_tick();
+    Metrics metrics;
+    std::vector<Captured> caps = capture_states(sources);
+    bench_primitives(caps, reps, metrics);
+    bench_end_to_end(files, metrics);
+
+    if(json_path == "-"){
+        write_json(std::cout, metrics);
+    }else{
+        std::cout << "states=" << caps.size() << " reps=" << reps << " datasets=" << files.size() << "\n";
+        for(const auto& [name, value] : metrics) std::cout << "  " << name << " " << value << "\n";
+        if(!json_path.empty()){
+            std::ofstream js(json_path);
+            write_json(js, metrics);
+            if(!js){
+                std::cerr << "failed to write " << json_path << "\n";
+                return 1;
+            }
+        }
+    }
+
+    if(!baseline_path.empty()){
+        std::map<std::string, double> base;
+        if(!read_json(baseline_path, base)){
+            std::cerr << "failed to read baseline " << baseline_path << "\n";
+            return 1;
+        }
+        // Keep stdout valid JSON when the metrics went there.
+        std::ostream& os = json_path == "-" ? std::cerr : std::cout;
+        return compare(os, metrics, base, threshold) ? 1 : 0;
+    }
+    return 0;
+}
@@ -0,0 +1,190 @@
+// Load generator for `cppsolver serve` (closed loop: every connection sends
+// one request, waits for its response, repeats).
+//
+//   cppsolver_loadgen (--unix PATH | --tcp PORT) --file PUZZLES
+//                     [--connections N] [--batch N] [--requests N]
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "puzzle_reader.hpp"
+#include "timing.hpp"
+
+namespace {
+
+struct Options {
+    std::string unix_path;
+    int tcp_port = 0;
+    std::string file;
+    int connections = 8;
+    size_t batch = 16;       // puzzles per request
+    size_t requests = 200;   // per connection
+};
+
+int connect_server(const Options& opt){
+    if(!opt.unix_path.empty()){
+        int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        std::strncpy(addr.sun_path, opt.unix_path.c_str(), sizeof(addr.sun_path) - 1);
+        if(fd >= 0 && ::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0) return fd;
+        if(fd >= 0) ::close(fd);
+        return -1;
+    }
+    int fd = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons((uint16_t)opt.tcp_port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if(fd >= 0 && ::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0){
+        int one = 1;
+        ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        return fd;
+    }
+    if(fd >= 0) ::close(fd);
+    return -1;
+}
+
+bool send_all(int fd, const std::string& s){
+    size_t off = 0;
+    while(off < s.size()){
+        ssize_t w = ::send(fd, s.data() + off, s.size() - off, MSG_NOSIGNAL);
+        if(w < 0 && errno == EINTR) continue;
+        if(w <= 0) return false;
+        off += (size_t)w;
+    }
+    return true;
+}
+
+// Reads one response (ends at the first empty line); returns its answer count
+// or -1 on error. `buf` carries bytes past the response over to the next call.
+long read_response(int fd, std::string& buf){
+    while(true){
+        size_t end = buf.find("\n\n");
+        if(end != std::string::npos){
+            long answers = 0;
+            for(size_t pos = 0; pos < end;){
+                size_t nl = buf.find('\n', pos);
+                if(buf[pos] != '#') ++answers;
+                pos = nl + 1;
+            }
+            buf.erase(0, end + 2);
+            return answers;
+        }
+        char tmp[16384];
+        ssize_t n = ::read(fd, tmp, sizeof(tmp));
+        if(n < 0 && errno == EINTR) continue;
+        if(n <= 0) return -1;
+        buf.append(tmp, (size_t)n);
+    }
+}
+} // namespace
+
+int main(int argc, char** argv){
+    Options opt;
+    for(int i = 1; i < argc; ++i){
+        std::string arg = argv[i];
+        if(i + 1 >= argc){
+            std::cerr << arg << " requires a value\n";
+            return 1;
+        }
+        const char* v = argv[++i];
+        if(arg == "--unix") opt.unix_path = v;
+        else if(arg == "--tcp") opt.tcp_port = std::atoi(v);
+        else if(arg == "--file") opt.file = v;
+        else if(arg == "--connections") opt.connections = std::max(1, std::atoi(v));
+        else if(arg == "--batch") opt.batch = std::max<size_t>(1, std::strtoull(v, nullptr, 10));
+        else if(arg == "--requests") opt.requests = std::max<size_t>(1, std::strtoull(v, nullptr, 10));
+        else{
+            std::cerr << "usage: cppsolver_loadgen (--unix PATH | --tcp PORT) --file PUZZLES"
+                         " [--connections N] [--batch N] [--requests N]\n";
+            return 1;
+        }
+    }
+    if((opt.unix_path.empty() && opt.tcp_port <= 0) || opt.file.empty()){
+        std::cerr << "cppsolver_loadgen needs --unix or --tcp, and --file\n";
+        return 1;
+    }
+
+    MappedFile in;
+    if(!in.open(opt.file)){
+        std::cerr << "Failed to open " << opt.file << ": " << std::strerror(errno) << "\n";
+        return 1;
+    }
+    std::vector<std::string_view> puzzles;
+    PuzzleLineReader reader(in.view());
+    PuzzleLine pl;
+    while(reader.next(pl)) puzzles.push_back(pl.text);
+    if(puzzles.empty()){
+        std::cerr << opt.file << " has no puzzles\n";
+        return 1;
+    }
+
+    timing::ns_per_tick();
+    std::mutex mu;
+    timing::LatencyHistogram latency;
+    size_t errors = 0, answered = 0;
+
+    auto client = [&](int id){
+        timing::LatencyHistogram local;
+        local.reserve(opt.requests);
+        size_t local_errors = 0, local_answered = 0;
+        int fd = connect_server(opt);
+        std::string buf, req;
+        size_t next = (size_t)id * opt.batch;
+        for(size_t r = 0; fd >= 0 && r < opt.requests; ++r){
+            req.clear();
+            for(size_t k = 0; k < opt.batch; ++k){
+                req += puzzles[next++ % puzzles.size()];
+                req += '\n';
+            }
+            req += '\n';
+            const uint64_t t0 = timing::ticks();
+            long got = send_all(fd, req) ? read_response(fd, buf) : -1;
+            local.add(timing::ticks_to_ns(timing::ticks() - t0));
+            if(got < 0) break;
+            if((size_t)got != opt.batch) ++local_errors;
+            local_answered += (size_t)got;
+        }
+        if(fd < 0) ++local_errors;
+        else ::close(fd);
+        std::lock_guard<std::mutex> lk(mu);
+        latency.merge(local);
+        errors += local_errors;
+        answered += local_answered;
+    };
+
+    const uint64_t wall_start = timing::mono_ns();
+    std::vector<std::thread> pool;
+    for(int c = 0; c < opt.connections; ++c) pool.emplace_back(client, c);
+    for(auto& th : pool) th.join();
+    const double wall_ms = timing::ns_to_ms(timing::mono_ns() - wall_start);
+    const double secs = wall_ms / 1000.0;
+
+    auto us = [](uint64_t ns){ return (double)ns / 1000.0; };
+    std::cout << "loadgen connections=" << opt.connections
+              << " batch=" << opt.batch
+              << " requests=" << latency.count()
+              << " puzzles=" << answered
+              << " errors=" << errors
+              << " wall_ms=" << wall_ms
+              << " requests_per_sec=" << (secs > 0.0 ? latency.count() / secs : 0.0)
+              << " puzzles_per_sec=" << (secs > 0.0 ? answered / secs : 0.0) << "\n";
+    std::cout << "latency_us p50=" << us(latency.percentile(50))
+              << " p90=" << us(latency.percentile(90))
+              << " p99=" << us(latency.percentile(99))
+              << " p99.9=" << us(latency.percentile(99.9))
+              << " max=" << us(latency.max()) << "\n";
+    return errors ? 1 : 0;
+}
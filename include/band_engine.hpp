@@ -0,0 +1,41 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <string_view>
+
+// Band-oriented alternative engine (selected with SolverConfig::engine).
+//
+// Candidates are stored digit-major per band: word [d*3 + b] holds the 27
+// cells of band b (3 rows x 9 cols, bit = row_in_band*9 + col) that still
+// allow digit d, so one band's nine digits are 9 x 32 bits and the whole grid
+// is 27 words (108 bytes). Row and box constraints are applied to a whole
+// band word at a time (including pointing/claiming through a 512-entry
+// segment table); columns are three bits spread over the band words. The
+// search copies the state on every branch instead of keeping a trail.
+struct BandState {
+    std::array<uint32_t, 27> cand{}; // [digit*3 + band]
+    std::array<uint32_t, 3> solved{}; // placed cells per band
+};
+
+class BandEngine {
+public:
+    // Solve; on success writes values 1..9 into out[81].
+    bool solve(std::string_view puzzle, uint8_t out[81]);
+    // Count solutions up to `limit`; out[] holds the last solution found.
+    int count(std::string_view puzzle, int limit, uint8_t out[81]);
+
+    uint64_t nodes() const { return nodes_; } // search nodes of the last call
+    // Stop a call after max_nodes search nodes or once timing::ticks() passes
+    // deadline (0 = none); aborted() tells whether the last call stopped.
+    void set_limits(uint64_t max_nodes, uint64_t deadline){ max_nodes_ = max_nodes; deadline_ = deadline; }
+    bool aborted() const { return aborted_; }
+
+private:
+    bool init(std::string_view puzzle, BandState& s);
+    bool search(BandState& s, int limit, int& found, uint8_t out[81]);
+
+    uint64_t nodes_ = 0;
+    uint64_t max_nodes_ = 0;
+    uint64_t deadline_ = 0;
+    bool aborted_ = false;
+};
@@ -0,0 +1,72 @@
+#pragma once
+#include <string_view>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include "config.hpp"
+#include "inference.hpp"
+#include "solve_cache.hpp"
+#include "portfolio.hpp"
+#include "stats.hpp"
+#include "timing.hpp"
+
+// One puzzle taken from an input file, with its 1-based source line number.
+// The text (or packed record) is a view into the caller's buffer (usually a
+// MappedFile).
+struct BatchPuzzle {
+    size_t line = 0;
+    std::string_view text;
+    const uint8_t* packed = nullptr; // set => solve from this record, not text
+};
+
+struct BatchOptions {
+    int threads = 1;         // worker count (each owns a SudokuSolver)
+    bool ordered = true;     // false => print "<line> <solution>" as chunks finish
+    bool print = true;       // false => solve only (benchmark)
+    size_t chunk = 64;       // puzzles per work item
+    int count_limit = 0;     // >0 => count solutions up to this limit instead of solving
+    bool record_latency = false; // fill BatchResult::latency (one sample per puzzle)
+};
+
+struct BatchThreadStats {
+    size_t puzzles = 0;
+    size_t solved = 0;       // count mode: puzzles with at least one solution
+    size_t unique = 0;       // count mode: puzzles with exactly one solution
+    size_t timeouts = 0;     // stopped by SolverConfig::limits
+    size_t steals = 0;       // chunks taken from another worker's queue
+    uint64_t nodes = 0;      // search nodes over all puzzles
+    SolverStats stats{};     // summed SolverStats (max for depth/trail peak)
+    InferenceStats inference{};
+    CacheStats cache{};      // this worker's solver cache
+    TTStats tt{};            // this worker's dead-state table
+    PortfolioStats portfolio{};
+    double busy_ms = 0.0;    // wall time spent solving chunks
+};
+
+struct BatchResult {
+    size_t puzzles = 0;
+    size_t solved = 0;
+    size_t unique = 0;
+    size_t timeouts = 0;
+    int count_limit = 0;
+    uint64_t nodes = 0;
+    SolverStats stats{};
+    InferenceStats inference{};
+    CacheStats cache{};      // summed over the per-worker caches
+    TTStats tt{};
+    PortfolioStats portfolio{};
+    double wall_ms = 0.0;
+    double cpu_ms = 0.0;     // process CPU time (all threads)
+    bool output_ok = true;   // false if writing the answers to stdout failed
+    timing::LatencyHistogram latency; // per-puzzle solve time, if requested
+    std::vector<BatchThreadStats> per_thread;
+};
+
+// Solve all puzzles on opt.threads workers. Chunks of puzzles are dealt out to
+// per-worker deques; idle workers steal from the opposite end of other deques.
+// Ordered printing instead hands out chunks in file order and prints each one
+// as soon as all earlier chunks are out; a worker more than kOrderedWindow
+// chunks per thread ahead of the printer waits, so memory stays bounded.
+BatchResult run_batch(const std::vector<BatchPuzzle>& puzzles,
+                      const SolverConfig& cfg,
+                      const BatchOptions& opt);
@@ -0,0 +1,119 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include "geometry.hpp"
+
+// Whole-board kernels over the 9 digit boards (SolverState::B).
+//
+// Each Bits81 is exactly one 128-bit lane, so the SSE2 path holds one digit
+// board per register and the AVX2 path two. The instruction set is fixed at
+// compile time (CPPSOLVER_SIMD in CMake, default: whatever -march enables);
+// SolverConfig::boards picks these kernels or the original per-cell loops at
+// runtime so both can be benchmarked from one binary.
+
+#if defined(CPPSOLVER_SIMD_SCALAR)
+#  define CPPSOLVER_SIMD_LEVEL 0
+#elif defined(__AVX2__)
+#  define CPPSOLVER_SIMD_LEVEL 2
+#elif defined(__SSE2__)
+#  define CPPSOLVER_SIMD_LEVEL 1
+#else
+#  define CPPSOLVER_SIMD_LEVEL 0
+#endif
+
+#if CPPSOLVER_SIMD_LEVEL >= 1
+#include <immintrin.h>
+#endif
+
+namespace simd {
+
+using Boards = std::array<geom::Bits81, 9>;
+
+constexpr const char* backend_name(){
+#if CPPSOLVER_SIMD_LEVEL == 2
+    return "avx2";
+#elif CPPSOLVER_SIMD_LEVEL == 1
+    return "sse2";
+#else
+    return "portable"; // bit-sliced kernels on plain uint64 limbs
+#endif
+}
+
+#if CPPSOLVER_SIMD_LEVEL >= 1
+inline __m128i load(const geom::Bits81& b){ return _mm_loadu_si128(reinterpret_cast<const __m128i*>(&b)); }
+inline void store(geom::Bits81& b, __m128i v){ _mm_storeu_si128(reinterpret_cast<__m128i*>(&b), v); }
+inline geom::Bits81 to_bits(__m128i v){ geom::Bits81 b; store(b, v); return b; }
+#endif
+
+// Clear `cells` from every digit board except `keep` (0..8), e.g. the other
+// candidates of a cell that is being fixed. Pass keep=-1 to clear all nine.
+inline void clear_cells_except(Boards& B, geom::Bits81 cells, int keep){
+    const geom::Bits81 saved = keep >= 0 ? geom::band(B[keep], cells) : geom::Bits81{};
+#if CPPSOLVER_SIMD_LEVEL == 2
+    const __m256i m = _mm256_broadcastsi128_si256(load(cells));
+    for(int d = 0; d < 8; d += 2){
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&B[d]));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(&B[d]), _mm256_andnot_si256(m, v));
+    }
+    store(B[8], _mm_andnot_si128(_mm256_castsi256_si128(m), load(B[8])));
+    if(keep >= 0) B[keep] = geom::bor(B[keep], saved);
+#elif CPPSOLVER_SIMD_LEVEL == 1
+    const __m128i m = load(cells);
+    for(int d = 0; d < 9; ++d) store(B[d], _mm_andnot_si128(m, load(B[d])));
+    if(keep >= 0) B[keep] = geom::bor(B[keep], saved);
+#else
+    for(int d = 0; d < 9; ++d) B[d] = geom::band(B[d], geom::bnot(cells));
+    if(keep >= 0) B[keep] = geom::bor(B[keep], saved);
+#endif
+}
+
+// Clear `cells` from one digit board, e.g. d from the peers of a cell fixed
+// to d.
+inline void clear_cells(geom::Bits81& b, geom::Bits81 cells){
+#if CPPSOLVER_SIMD_LEVEL >= 1
+    store(b, _mm_andnot_si128(load(cells), load(b)));
+#else
+    b = geom::band(b, geom::bnot(cells));
+#endif
+}
+
+// Every open cell of `cells` lost one candidate: move it from bucket k to
+// k-1 in all ten MRV buckets at once (new_k = (old_k & ~cells) |
+// (old_k+1 & cells)). Cells land in bucket 1 or 0 when they become singles
+// or dead ends.
+inline void move_down(std::array<geom::Bits81, 10>& bk, geom::Bits81 cells){
+#if CPPSOLVER_SIMD_LEVEL >= 1
+    const __m128i a = load(cells);
+    __m128i carry = _mm_setzero_si128();
+    for(int k = 9; k >= 0; --k){
+        const __m128i v = load(bk[k]);
+        store(bk[k], _mm_or_si128(_mm_andnot_si128(a, v), carry));
+        carry = _mm_and_si128(v, a);
+    }
+#else
+    geom::Bits81 carry{};
+    for(int k = 9; k >= 0; --k){
+        const geom::Bits81 v = bk[k];
+        bk[k] = geom::bor(geom::band(v, geom::bnot(cells)), carry);
+        carry = geom::band(v, cells);
+    }
+#endif
+}
+
+// unit_digit_count for all 27 units x 9 digits.
+inline void unit_counts(const Boards& B, int counts[27][9]){
+    for(int u = 0; u < 27; ++u){
+#if CPPSOLVER_SIMD_LEVEL >= 1
+        const __m128i um = load(geom::UNIT_MASK[u]);
+        for(int d = 0; d < 9; ++d){
+            __m128i v = _mm_and_si128(load(B[d]), um);
+            counts[u][d] = __builtin_popcountll((uint64_t)_mm_cvtsi128_si64(v))
+                         + __builtin_popcountll((uint64_t)_mm_cvtsi128_si64(_mm_unpackhi_epi64(v, v)));
+        }
+#else
+        for(int d = 0; d < 9; ++d) counts[u][d] = geom::popcnt(geom::band(B[d], geom::UNIT_MASK[u]));
+#endif
+    }
+}
+
+} // namespace simd
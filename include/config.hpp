@@ -1,4 +1,5 @@
 #pragma once
+#include <cstddef>
 #include <cstdint>
 
 namespace cfg {
@@ -9,6 +10,13 @@ constexpr bool kDebugChecks = true;
 constexpr bool kDebugChecks = false;
 #endif
 
+// Collect SolverStats counters (CMake option CPPSOLVER_STATS, default ON).
+#ifndef CPPSOLVER_NO_STATS
+constexpr bool kStats = true;
+#else
+constexpr bool kStats = false;
+#endif
+
 // Queue capacities (upper bounds).
 constexpr int kMaxL4Queue = 81;
 constexpr int kMaxL1Queue = 27*9;
@@ -24,6 +32,90 @@ struct DualConfig {
     int max_py_candidates = 0; // 0 => complete
 };
 
+// Weights of the linear scores in scoring.hpp. The defaults are the
+// original hand-picked values; `cppsolver tune` searches over them.
+struct ScoringConfig {
+    // score_digit: peers of the cell that still allow d, cells left for d
+    float influence = 2.0f;
+    float scarcity = -1.0f;
+    // select_pressure_cell: units shared with px, common peers, candidates
+    float shared_units = 3.0f;
+    float overlap = 2.0f;
+    float mrv = -1.0f;
+};
+
+// How the DFS picks the cell to branch on (cell engine). Mrv: fewest
+// candidates, lowest index first. Wdeg: fewest candidates, ties broken by the
+// conflict weight of the cell's three units (dom/wdeg style, see
+// SolverState::unit_weight).
+enum class Branching : uint8_t { Mrv = 0, Wdeg = 1 };
+
+// Implementation of whole-board updates (unit counts, clearing a fixed cell
+// from the other digit boards and its digit from the peers). Simd uses
+// board_simd.hpp kernels.
+enum class BoardBackend : uint8_t { Scalar = 0, Simd = 1 };
+
+// Propagation/search engine behind SudokuSolver. Cell is the event-driven
+// per-cell engine (trail undo); Band is band_engine.hpp (copy per branch).
+enum class Engine : uint8_t { Cell = 0, Band = 1 };
+
+// How a failed DFS branch is rolled back: replay the trail backwards, memcpy
+// a per-depth state snapshot, or snapshot only while depth < snapshot_depth.
+enum class RestoreMode : uint8_t { Trail = 0, Snapshot = 1, Hybrid = 2 };
+
+// Optional inference stages run by propagate() once singles and pointing have
+// reached a fixpoint, cheapest first; any elimination drops back to singles.
+// All off by default (the classic propagation level).
+struct InferenceConfig {
+    bool claiming = false;       // row/col confined to one box => clear rest of box
+    bool naked_pairs = false;
+    bool hidden_pairs = false;
+    bool naked_triples = false;
+    bool hidden_triples = false;
+    bool xwing = false;          // rows and columns
+
+    bool any() const {
+        return claiming || naked_pairs || hidden_pairs || naked_triples || hidden_triples || xwing;
+    }
+};
+
+// Per-call bounds on SudokuSolver::solve / count_solutions (0 = none). A
+// call that reaches one stops early and reports SolveResult::Timeout.
+struct SolveLimits {
+    uint64_t max_nodes = 0;  // DFS nodes
+    size_t max_trail = 0;    // trail entries (cell engine)
+    uint64_t max_us = 0;     // wall time, checked every 1024 nodes
+
+    bool any() const { return max_nodes || max_trail || max_us; }
+};
+
+// Intra-puzzle parallel search (cell engine, single-cell branching). A
+// dfs_single that passes node_budget nodes is abandoned and the top of its
+// tree is split over `threads` workers (parallel_search.hpp).
+struct ParallelConfig {
+    int threads = 1;              // 1 => off, 0 => all cores
+    uint64_t node_budget = 5000;  // sequential nodes before splitting
+};
+
 struct SolverConfig {
     DualConfig dual{};
+    ScoringConfig scoring{};
+    InferenceConfig inference{};
+    ParallelConfig parallel{};
+    SolveLimits limits{};
+    // Race dfs_single and DualConfig variants on separate threads for every
+    // puzzle that needs a search (portfolio.hpp); `dual` is then ignored.
+    bool portfolio = false;
+    Branching branching = Branching::Mrv;
+    float wdeg_decay = 0.95f; // Wdeg: the bump grows by 1/decay per conflict
+    BoardBackend boards = BoardBackend::Scalar;
+    Engine engine = Engine::Cell;
+    RestoreMode restore = RestoreMode::Trail;
+    int snapshot_depth = 6; // Hybrid: snapshot levels [0, snapshot_depth)
+    // >0 => SudokuSolver::solve looks puzzles up in an LRU of this many
+    // canonical forms first (solve_cache.hpp). count_solutions is not cached.
+    size_t cache_entries = 0;
+    // >0 => the cell-engine DFS keeps a table of dead placement sets in this
+    // many MiB, shared by all searches of one SudokuSolver (transposition.hpp).
+    size_t tt_mb = 0;
 };
@@ -0,0 +1,19 @@
+#pragma once
+#include <string>
+#include "config.hpp"
+
+// Search parameters as a text file: one `key = value` per line, `#` starts a
+// comment. Keys are the DualConfig and ScoringConfig fields (dual.enabled,
+// dual.max_mrv_px, ..., scoring.influence, ...); a file may set any subset
+// of them. Written by `cppsolver tune`, read by `--config`.
+
+// Apply the file at `path` on top of cfg. Values are range-checked per key
+// (and dual.max_depth >= dual.min_depth). On failure returns false with a
+// message (naming the line) in err; cfg may then be partly updated.
+bool load_config_file(const std::string& path, SolverConfig& cfg, std::string& err);
+
+// Every key, one per line, after `header` (already '#'-prefixed lines or "").
+std::string format_config(const SolverConfig& cfg, const std::string& header = "");
+
+bool save_config_file(const std::string& path, const SolverConfig& cfg,
+                      const std::string& header, std::string& err);
@@ -3,5 +3,16 @@
 #include "config.hpp"
 #include <vector>
 
+// All searches return false early, with S.aborted set and the state rolled
+// back, once one of the SolverState limits (node_limit, trail_limit,
+// deadline, stop) is reached.
 bool dfs_single(SolverState& S, const SolverConfig& cfg);
+// Candidates of cell c in the order dfs_single tries them; returns the count.
+int ordered_candidates(SolverState& S, const SolverConfig& cfg, int c, int cand[9]);
 bool dfs_dual(SolverState& S, const SolverConfig& cfg);
+
+// Count solutions below the current (propagated) state, stopping once `limit`
+// are found. Always uses single-cell branching: the dual search revisits
+// subtrees and would count the same solution twice. When the limit is hit the
+// state is left on the last solution found; otherwise it is fully undone.
+int dfs_count(SolverState& S, const SolverConfig& cfg, int limit);
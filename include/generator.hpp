@@ -0,0 +1,38 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include "config.hpp"
+
+// Difficulty: the weakest rule set that solves a puzzle without guessing.
+// Each grade adds InferenceConfig stages to the previous one (Singles: the
+// default propagation only; Pairs: naked and hidden pairs; ...). Search means
+// none of them does.
+enum class Grade : uint8_t { Singles = 0, Claiming, Pairs, Triples, XWing, Search };
+
+const char* grade_name(Grade g);
+bool parse_grade(std::string_view name, Grade& out);
+
+struct GeneratorOptions {
+    size_t count = 100;          // puzzles to emit
+    int threads = 1;             // 0 => all cores
+    uint64_t seed = 1;           // run seed; worker w draws from seed and w
+    Grade min_grade = Grade::Singles; // difficulty range of the emitted
+    Grade max_grade = Grade::Search;  // puzzles
+    size_t max_attempts = 0;     // stop after this many minimal puzzles (0 => no limit)
+    int fd = 1;                  // output: one puzzle per line, '.' = empty
+};
+
+struct GeneratorResult {
+    size_t generated = 0;        // puzzles written
+    size_t attempts = 0;         // minimal puzzles built (including ones below min_grade)
+    double wall_ms = 0.0;
+};
+
+// Each worker fills a random grid (SudokuSolver::fill_random) and removes
+// clues in random order, putting a clue back when the puzzle would lose its
+// unique solution or grade above max_grade (checked per removal, so no
+// puzzle is thrown away for being too hard). Removing clues never lowers the
+// grade, so a minimal puzzle still below min_grade is dropped. Output
+// order is whatever finishes first.
+GeneratorResult generate_puzzles(const GeneratorOptions& opt, const SolverConfig& cfg);
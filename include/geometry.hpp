@@ -4,14 +4,6 @@
 
 namespace geom {
 
-// 81-cell indexing: row-major 0..80
-extern std::array<int,81> ROW;
-extern std::array<int,81> COL;
-extern std::array<int,81> BOX;
-
-// Unit ids: 0..8 rows, 9..17 cols, 18..26 boxes
-extern std::array<std::array<int,3>,81> CELL_UNITS;
-
 // Masks (each mask is 81 bits split into two uint64 limbs: lo [0..63], hi [64..80])
 struct Bits81 {
     uint64_t lo; // bits 0..63
@@ -20,46 +12,137 @@ struct Bits81 {
     constexpr Bits81(uint64_t lo_=0, uint64_t hi_=0) : lo(lo_), hi(hi_) {}
 };
 
-inline bool any(Bits81 x){ return (x.lo | x.hi) != 0ULL; }
+constexpr bool any(Bits81 x){ return (x.lo | x.hi) != 0ULL; }
 
-inline int popcnt(Bits81 x){
+constexpr int popcnt(Bits81 x){
     return __builtin_popcountll(x.lo) + __builtin_popcountll(x.hi);
 }
-inline Bits81 band(Bits81 a, Bits81 b){ return Bits81{a.lo & b.lo, a.hi & b.hi}; }
-inline Bits81 bor (Bits81 a, Bits81 b){ return Bits81{a.lo | b.lo, a.hi | b.hi}; }
-inline Bits81 bxor(Bits81 a, Bits81 b){ return Bits81{a.lo ^ b.lo, a.hi ^ b.hi}; }
-inline Bits81 bnot(Bits81 a){ 
+constexpr Bits81 band(Bits81 a, Bits81 b){ return Bits81{a.lo & b.lo, a.hi & b.hi}; }
+constexpr Bits81 bor (Bits81 a, Bits81 b){ return Bits81{a.lo | b.lo, a.hi | b.hi}; }
+constexpr Bits81 bxor(Bits81 a, Bits81 b){ return Bits81{a.lo ^ b.lo, a.hi ^ b.hi}; }
+constexpr Bits81 bnot(Bits81 a){ 
     // negate only valid bits (81)
     const uint64_t HI_MASK = (1ULL<<17) - 1ULL; // lower 17 bits valid
     return Bits81{~a.lo, (~a.hi) & HI_MASK};
 }
 
+// Single-cell mask
+constexpr Bits81 cell_bit(int i){
+    return i < 64 ? Bits81{1ULL<<i, 0} : Bits81{0, 1ULL<<(i-64)};
+}
+
 // Clear bit i (0..80), Set bit i, Test bit i
-inline void set_bit(Bits81& m, int i){
+constexpr void set_bit(Bits81& m, int i){
     if(i < 64) m.lo |= (1ULL<<i); else m.hi |= (1ULL<<(i-64));
 }
-inline void clr_bit(Bits81& m, int i){
+constexpr void clr_bit(Bits81& m, int i){
     if(i < 64) m.lo &= ~(1ULL<<i); else m.hi &= ~(1ULL<<(i-64));
 }
-inline bool test_bit(Bits81 m, int i){
+constexpr bool test_bit(Bits81 m, int i){
     if(i < 64) return (m.lo >> i) & 1ULL; else return (m.hi >> (i-64)) & 1ULL;
 }
 
 // Return index of least significant set bit; undefined if mask==0.
-inline int ctz(Bits81 m){
+constexpr int ctz(Bits81 m){
     if(m.lo) return __builtin_ctzll(m.lo);
     return 64 + __builtin_ctzll(m.hi);
 }
 
+// Geometry tables are generated at compile time: no init() call, lookups with
+// constant indices fold to immediates, and concurrent solver construction is safe.
+namespace detail {
+
+constexpr std::array<int,81> make_row(){
+    std::array<int,81> t{};
+    for(int i=0;i<81;++i) t[i] = i / 9;
+    return t;
+}
+constexpr std::array<int,81> make_col(){
+    std::array<int,81> t{};
+    for(int i=0;i<81;++i) t[i] = i % 9;
+    return t;
+}
+constexpr std::array<int,81> make_box(){
+    std::array<int,81> t{};
+    for(int i=0;i<81;++i) t[i] = (i/9/3)*3 + (i%9)/3;
+    return t;
+}
+
+} // namespace detail
+
+// 81-cell indexing: row-major 0..80
+inline constexpr std::array<int,81> ROW = detail::make_row();
+inline constexpr std::array<int,81> COL = detail::make_col();
+inline constexpr std::array<int,81> BOX = detail::make_box();
+
+namespace detail {
+
+// Unit ids: 0..8 rows, 9..17 cols, 18..26 boxes
+constexpr std::array<std::array<int,3>,81> make_cell_units(){
+    std::array<std::array<int,3>,81> t{};
+    for(int i=0;i<81;++i) t[i] = {ROW[i], 9 + COL[i], 18 + BOX[i]};
+    return t;
+}
+constexpr std::array<Bits81,9> make_row_mask(){
+    std::array<Bits81,9> t{};
+    for(int i=0;i<81;++i) set_bit(t[ROW[i]], i);
+    return t;
+}
+constexpr std::array<Bits81,9> make_col_mask(){
+    std::array<Bits81,9> t{};
+    for(int i=0;i<81;++i) set_bit(t[COL[i]], i);
+    return t;
+}
+constexpr std::array<Bits81,9> make_box_mask(){
+    std::array<Bits81,9> t{};
+    for(int i=0;i<81;++i) set_bit(t[BOX[i]], i);
+    return t;
+}
+// PEER_MASK: all cells sharing row or col or box (excluding self)
+constexpr std::array<Bits81,81> make_peer_mask(){
+    std::array<Bits81,81> t{};
+    for(int i=0;i<81;++i){
+        for(int j=0;j<81;++j){
+            if(j != i && (ROW[i]==ROW[j] || COL[i]==COL[j] || BOX[i]==BOX[j])) set_bit(t[i], j);
+        }
+    }
+    return t;
+}
+constexpr std::array<Bits81,27> make_unit_mask(){
+    std::array<Bits81,27> t{};
+    for(int i=0;i<81;++i){
+        set_bit(t[ROW[i]], i);       // units 0..8 rows
+        set_bit(t[9 + COL[i]], i);   // units 9..17 cols
+        set_bit(t[18 + BOX[i]], i);  // units 18..26 boxes
+    }
+    return t;
+}
+// [box][0..2]: the three rows (resp. cols) of a box
+constexpr std::array<std::array<Bits81,3>,9> make_box_row_mask(){
+    std::array<std::array<Bits81,3>,9> t{};
+    for(int i=0;i<81;++i) set_bit(t[BOX[i]][ROW[i] % 3], i);
+    return t;
+}
+constexpr std::array<std::array<Bits81,3>,9> make_box_col_mask(){
+    std::array<std::array<Bits81,3>,9> t{};
+    for(int i=0;i<81;++i) set_bit(t[BOX[i]][COL[i] % 3], i);
+    return t;
+}
+
+} // namespace detail
+
+inline constexpr std::array<std::array<int,3>,81> CELL_UNITS = detail::make_cell_units();
+
 // Precomputed masks
-extern std::array<Bits81, 9> ROW_MASK;
-extern std::array<Bits81, 9> COL_MASK;
-extern std::array<Bits81, 9> BOX_MASK;
-extern std::array<Bits81,81> PEER_MASK;          // mask of peers for each cell
-extern std::array<Bits81,27> UNIT_MASK;          // 27 units
-extern std::array<std::array<Bits81,3>,9> BOX_ROW_MASK; // [box][0..2]
-extern std::array<std::array<Bits81,3>,9> BOX_COL_MASK; // [box][0..2]
-
-void init();    // must be called once at startup
+inline constexpr std::array<Bits81, 9> ROW_MASK = detail::make_row_mask();
+inline constexpr std::array<Bits81, 9> COL_MASK = detail::make_col_mask();
+inline constexpr std::array<Bits81, 9> BOX_MASK = detail::make_box_mask();
+inline constexpr std::array<Bits81,81> PEER_MASK = detail::make_peer_mask();  // mask of peers for each cell
+inline constexpr std::array<Bits81,27> UNIT_MASK = detail::make_unit_mask();  // 27 units
+inline constexpr std::array<std::array<Bits81,3>,9> BOX_ROW_MASK = detail::make_box_row_mask(); // [box][0..2]
+inline constexpr std::array<std::array<Bits81,3>,9> BOX_COL_MASK = detail::make_box_col_mask(); // [box][0..2]
+
+static_assert(popcnt(PEER_MASK[0]) == 20 && popcnt(PEER_MASK[80]) == 20, "every cell has 20 peers");
+static_assert(popcnt(UNIT_MASK[26]) == 9 && test_bit(UNIT_MASK[26], 80), "box 8 ends at cell 80");
 
 } // namespace geom
@@ -0,0 +1,38 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include "config.hpp"
+
+struct SolverState; // forward
+
+// Stages of InferenceConfig in the order propagate() tries them.
+enum class InferenceStage : uint8_t {
+    Claiming = 0, NakedPairs, HiddenPairs, NakedTriples, HiddenTriples, XWing, Count
+};
+constexpr int kInferenceStages = (int)InferenceStage::Count;
+
+const char* inference_stage_name(InferenceStage s);
+bool inference_stage_enabled(const InferenceConfig& c, InferenceStage s);
+
+// Cost accounting per stage: how often it ran, how many candidates it removed
+// and the time spent inside it (timing::ticks). Only collected when
+// cfg::kStats.
+struct InferenceStats {
+    std::array<uint64_t, kInferenceStages> runs{};
+    std::array<uint64_t, kInferenceStages> eliminations{};
+    std::array<uint64_t, kInferenceStages> ticks{};
+
+    InferenceStats& operator+=(const InferenceStats& o){
+        for(int i = 0; i < kInferenceStages; ++i){
+            runs[i] += o.runs[i];
+            eliminations[i] += o.eliminations[i];
+            ticks[i] += o.ticks[i];
+        }
+        return *this;
+    }
+};
+
+// Run the enabled stages of *S.inference in order until one eliminates
+// something. Returns 1 if candidates were removed (queues may hold new
+// events), 0 if no stage made progress, -1 on contradiction.
+int run_inference(SolverState& S);
@@ -0,0 +1,53 @@
+#pragma once
+#include <cstddef>
+#include <string_view>
+#include <vector>
+
+// Line printed for puzzles without a solution.
+inline constexpr std::string_view kUnsolvedText = "UNSOLVED/CONTRADICTION";
+// Line printed when a SolverConfig::limits bound stopped the search.
+inline constexpr std::string_view kTimeoutText = "TIMEOUT";
+// Line printed (by --stream) for an input line longer than its limit.
+inline constexpr std::string_view kLineTooLongText = "# error=line too long";
+
+// Large reusable output buffer flushed with write(2). Callers format directly
+// into reserve()d space, so emitting a solution never allocates.
+class OutputBuffer {
+public:
+    explicit OutputBuffer(int fd = 1, size_t capacity = 1 << 20);
+    ~OutputBuffer();
+    OutputBuffer(const OutputBuffer&) = delete;
+    OutputBuffer& operator=(const OutputBuffer&) = delete;
+
+    // Pointer to at least n writable bytes; follow with commit(n).
+    inline char* reserve(size_t n){
+        if(len_ + n > buf_.size()) make_room(n);
+        return buf_.data() + len_;
+    }
+    inline void commit(size_t n){ len_ += n; }
+
+    inline void put(char ch){ *reserve(1) = ch; commit(1); }
+    void append(std::string_view s);
+    void append_uint(unsigned long long v);
+
+    size_t size() const { return len_; }
+    std::string_view view() const { return {buf_.data(), len_}; }
+    void clear(){ len_ = 0; }
+    bool flush();   // false if write(2) failed
+    bool ok() const { return ok_; }
+
+private:
+    void make_room(size_t n);
+
+    int fd_;
+    std::vector<char> buf_;
+    size_t len_ = 0;
+    bool ok_ = true;
+};
+
+// Bounded solution count as printed by --count: the number itself, or "many"
+// once a limit of 2 or more was reached.
+inline void append_count(OutputBuffer& out, int count, int limit){
+    if(limit >= 2 && count >= limit) out.append("many");
+    else out.append_uint((unsigned long long)count);
+}
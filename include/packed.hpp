@@ -0,0 +1,56 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// Packed puzzle file (little-endian):
+//
+//   header   16 bytes: "SUDP", u16 version (1), u16 flags, u64 record count
+//   records  count x 41 bytes: cell i in byte i/2, low nibble for even i,
+//            high nibble for odd i; 0 = empty, 1..9 = digit
+//   index    count x u64 source line numbers, if flags & kPackedHasIndex
+//
+// A record can hold a puzzle or a solved grid; both decode the same way.
+namespace packed {
+
+inline constexpr char kMagic[4] = {'S', 'U', 'D', 'P'};
+inline constexpr uint16_t kVersion = 1;
+inline constexpr uint16_t kHasIndex = 1;
+inline constexpr size_t kHeaderBytes = 16;
+inline constexpr size_t kRecordBytes = 41;
+
+// True if buf starts with a packed header (the format check for --file).
+bool is_packed(std::string_view buf);
+
+// Text grid ('1'..'9' are clues, anything else empty, short lines padded)
+// to one record.
+void pack_grid(std::string_view text, uint8_t* rec);
+// One record to 81 chars, '.' for empty cells; no terminator.
+void unpack_grid(const uint8_t* rec, char* out);
+
+inline int cell(const uint8_t* rec, int i){
+    return (rec[i >> 1] >> ((i & 1) * 4)) & 0xF;
+}
+
+// Header for `count` records.
+void write_header(uint8_t* out, uint64_t count, uint16_t flags);
+
+// Zero-copy view of a packed buffer (usually a MappedFile).
+class Reader {
+public:
+    // False (with a reason in err) if buf is not a well-formed packed file.
+    bool open(std::string_view buf, std::string& err);
+    uint64_t size() const { return count_; }
+    bool has_index() const { return index_ != nullptr; }
+    const uint8_t* record(uint64_t i) const { return records_ + i * kRecordBytes; }
+    // Source line of record i, or i + 1 without an index.
+    uint64_t line(uint64_t i) const;
+
+private:
+    const uint8_t* records_ = nullptr;
+    const uint8_t* index_ = nullptr;
+    uint64_t count_ = 0;
+};
+
+} // namespace packed
@@ -0,0 +1,17 @@
+#pragma once
+#include "state.hpp"
+#include "config.hpp"
+
+// Search one puzzle on cfg.parallel.threads workers. S must be propagated
+// and not yet solved. The top levels of the dfs_single tree (same cell
+// choice, same candidate order) are expanded until there are a few subtrees
+// per worker; those are dealt round-robin to work-stealing queues, each
+// worker searches them with dfs_single on its own copy of S (and its own
+// trail), and the first solution found stops the rest.
+//
+// Workers inherit S's trail_limit and deadline and split what is left of
+// its node_limit; if one of them runs out the search stops with S.aborted.
+// On success S.cell_value holds the solution. S.nodes, S.stats and
+// S.inference_stats include the workers' searches; on failure S is back
+// where it started.
+bool parallel_dfs(SolverState& S, const SolverConfig& cfg);
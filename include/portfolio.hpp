@@ -0,0 +1,34 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include "state.hpp"
+#include "config.hpp"
+
+// Search strategies raced by SolverConfig::portfolio: dfs_single plus a few
+// DualConfig variants of dfs_dual.
+constexpr int kPortfolioStrategies = 4;
+
+const char* portfolio_strategy_name(int i);   // "single", "dual", ...
+DualConfig portfolio_strategy(int i);         // enabled == false => dfs_single
+
+// Races per strategy: how many each won (first to a definite answer).
+struct PortfolioStats {
+    uint64_t races = 0;
+    std::array<uint64_t, kPortfolioStrategies> wins{};
+
+    PortfolioStats& operator+=(const PortfolioStats& o){
+        races += o.races;
+        for(int i = 0; i < kPortfolioStrategies; ++i) wins[i] += o.wins[i];
+        return *this;
+    }
+};
+
+// Search S (propagated, not yet solved) with every strategy at once: the
+// calling thread runs the first, one thread each runs the others, all on
+// their own copy of S and trail. The first to find a solution or prove there
+// is none stops the rest through a shared flag. S's limits apply to every
+// strategy; if all of them run out, S.aborted is set.
+//
+// Returns the winner's answer and leaves its cell_value, nodes and search
+// stats in S; the winner's index is returned in `winner` (-1 if none).
+bool portfolio_dfs(SolverState& S, const SolverConfig& cfg, int& winner);
@@ -0,0 +1,61 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <cstddef>
+#include <cstdint>
+#include "packed.hpp"
+
+// Read-only memory mapping of a whole file. Views handed out stay valid for
+// the lifetime of the MappedFile.
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const std::string& path); // false on error (errno is preserved)
+    void close();
+    std::string_view view() const { return std::string_view(data_, size_); }
+
+private:
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+};
+
+struct PuzzleLine {
+    size_t line = 0;        // 1-based line number
+    std::string_view text;  // trimmed, never empty, never a '#' comment
+    const uint8_t* packed = nullptr; // packed record instead of text (PuzzleSource)
+};
+
+// Splits a buffer into puzzle lines without copying: skips blank lines and
+// '#' comments, trims surrounding whitespace.
+class PuzzleLineReader {
+public:
+    explicit PuzzleLineReader(std::string_view buf) : buf_(buf) {}
+    bool next(PuzzleLine& out);
+
+private:
+    std::string_view buf_;
+    size_t pos_ = 0;
+    size_t line_ = 0;
+};
+
+// --file input in either format: packed records (packed.hpp) when the
+// buffer starts with the packed magic, text lines otherwise. Packed records
+// come back as PuzzleLine::packed with an empty text.
+class PuzzleSource {
+public:
+    bool open(std::string_view buf, std::string& err); // false: bad packed header
+    bool is_packed() const { return is_packed_; }
+    bool next(PuzzleLine& out);
+
+private:
+    PuzzleLineReader text_{std::string_view()};
+    packed::Reader packed_;
+    uint64_t pos_ = 0;
+    bool is_packed_ = false;
+};
+
+std::string_view trim_view(std::string_view in);
@@ -0,0 +1,36 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include "config.hpp"
+
+// Line protocol, on a Unix stream socket and/or a localhost TCP port:
+//
+//   request:  puzzle lines ('#' lines ignored), ended by an empty line
+//   response: one answer per puzzle (solution, UNSOLVED/CONTRADICTION, or the
+//             count with count_limit), then
+//             "# puzzles=N solved=M queue_us=Q solve_us=S" and an empty line
+//
+// queue_us is the time from the request's last line arriving to a worker
+// taking it; solve_us is the worker's time for the whole batch. Requests may
+// be pipelined; responses on a connection come back in request order.
+//
+// A connection stops being read while it has max_inflight requests queued or
+// solving, or max_output response bytes not yet sent, so a client that
+// pipelines without reading cannot grow the server without bound. A line
+// longer than max_line gets "# error=line too long" and the connection is
+// closed.
+struct ServeOptions {
+    std::string unix_path;          // empty => no Unix socket
+    int tcp_port = 0;               // 0 => no TCP listener (binds 127.0.0.1)
+    int threads = 0;                // solver workers, 0 => all cores
+    int count_limit = 0;            // >0 => answer with solution counts
+    size_t max_request = 100000;    // puzzles per request before it is rejected
+    size_t max_line = 1024;         // bytes per line
+    size_t max_inflight = 64;       // requests per connection
+    size_t max_output = 16u << 20;  // unsent response bytes per connection
+};
+
+// One epoll thread owns all sockets and parses requests; a pool of workers,
+// each with its own SudokuSolver, solves whole requests. Runs until SIGINT or
+// SIGTERM; returns the process exit status.
+int run_server(const SolverConfig& cfg, const ServeOptions& opt);
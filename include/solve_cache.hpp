@@ -0,0 +1,94 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// Result cache keyed by a canonical form of the puzzle under the Sudoku
+// symmetry group (transpose, band/stack and row/column permutations, digit
+// relabelling), so repeats and isomorphic variants share one entry.
+//
+// Canonical form: for each orientation, bands/rows and stacks/columns are
+// ordered by clue-count invariants; orderings that tie are enumerated (up to
+// kMaxCanonicalCandidates per orientation) and digits are renumbered by first
+// appearance. The lexicographically smallest grid wins. When the ties allow
+// too many orderings only the first is used, so a few isomorphic puzzles may
+// miss each other; the key is always a true image of the puzzle, so a hit is
+// always correct.
+
+using Grid81 = std::array<uint8_t, 81>; // 0 = empty, 1..9 = digit
+
+inline constexpr int kMaxCanonicalCandidates = 256;
+
+struct CanonicalForm {
+    Grid81 grid{};          // the cache key
+    bool transpose = false; // applied before the row/column orders
+    uint8_t row[9]{};       // canonical row r is (oriented) row row[r]
+    uint8_t col[9]{};
+    uint8_t relabel[10]{};  // original digit -> canonical digit (0 -> 0)
+
+    // A solution of the canonical grid as a solution of the original puzzle,
+    // and the reverse.
+    void to_original(const uint8_t* canon, uint8_t* out) const;
+    void to_canonical(const uint8_t* orig, uint8_t* out) const;
+};
+
+void canonicalize(const Grid81& puzzle, CanonicalForm& out);
+
+struct CacheStats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
+
+    CacheStats& operator+=(const CacheStats& o){
+        hits += o.hits;
+        misses += o.misses;
+        evictions += o.evictions;
+        return *this;
+    }
+};
+
+// Bounded LRU from canonical grid to canonical solution (or "no solution").
+// Not thread-safe: each SudokuSolver owns one.
+class SolveCache {
+public:
+    struct Entry {
+        bool solved = false;
+        Grid81 solution{};
+    };
+
+    explicit SolveCache(size_t capacity);
+
+    // Entry for key (marked most recently used), or null. Counts a hit or miss.
+    const Entry* find(const Grid81& key);
+    // Add key as most recently used, evicting the least recently used entry
+    // when full. key must not be present.
+    void insert(const Grid81& key, bool solved, const uint8_t* solution);
+
+    size_t size() const { return map_.size(); }
+    size_t capacity() const { return capacity_; }
+    const CacheStats& stats() const { return stats_; }
+
+private:
+    struct KeyHash {
+        size_t operator()(const Grid81& g) const;
+    };
+    struct Node {
+        Grid81 key{};
+        Entry entry;
+        uint32_t prev = kNone;
+        uint32_t next = kNone;
+    };
+    static constexpr uint32_t kNone = ~0u;
+
+    void unlink(uint32_t i);
+    void push_front(uint32_t i);
+
+    size_t capacity_;
+    std::vector<Node> nodes_;
+    std::unordered_map<Grid81, uint32_t, KeyHash> map_;
+    uint32_t head_ = kNone; // most recently used
+    uint32_t tail_ = kNone;
+    CacheStats stats_{};
+};
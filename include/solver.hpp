@@ -1,7 +1,13 @@
 #pragma once
+#include <memory>
 #include <string>
+#include <string_view>
 #include "state.hpp"
 #include "trail.hpp"
+#include "band_engine.hpp"
+#include "solve_cache.hpp"
+#include "portfolio.hpp"
+#include "transposition.hpp"
 struct SolverTimings {
     double init_wall_ms = 0.0;
     double init_cpu_ms = 0.0;
@@ -11,16 +17,65 @@ struct SolverTimings {
     double search_cpu_ms = 0.0;
 };
 
+// Outcome of the last solve/count_solutions/fill_random call. Timeout means
+// a SolverConfig::limits bound stopped the search before it could decide.
+enum class SolveResult : uint8_t { Solved, Unsolved, Timeout };
+
 class SudokuSolver {
 public:
     explicit SudokuSolver(const SolverConfig& cfg = SolverConfig());
-    bool solve(const std::string& puzzle, SolverTimings* timings = nullptr);
+    // Uses `tt` as its dead-state table instead of building one of
+    // SolverConfig::tt_mb, so solvers on several threads can share it.
+    SudokuSolver(const SolverConfig& cfg, std::shared_ptr<TranspositionTable> tt);
+    bool solve(std::string_view puzzle, SolverTimings* timings = nullptr);
+    // Number of solutions, stopping at `limit` (limit=2 answers "is it unique?").
+    // If the count reaches the limit, solution_string() holds the last one found.
+    int count_solutions(std::string_view puzzle, int limit);
+    // Same, from one packed record (see packed.hpp); the state is built
+    // straight from the nibbles.
+    bool solve_packed(const uint8_t* rec, SolverTimings* timings = nullptr);
+    int count_solutions_packed(const uint8_t* rec, int limit);
+    // Random complete grid: dfs_single from an empty board, trying each cell's
+    // candidates in an order drawn from `seed`. The grid is left in state().
+    bool fill_random(uint64_t seed);
     std::string solution_string() const;
+    // Write the 81 digits ('0' for unfilled cells) to out; no terminator.
+    void solution_into(char* out) const;
+    // With Engine::Band only cell_value is meaningful after a solve.
     const SolverState& state() const { return S_; }
-    void set_config(const SolverConfig& cfg){ config_ = cfg; }
+    SolveResult result() const { return result_; }
+    // Search nodes visited by the last solve/count_solutions call.
+    uint64_t nodes() const { return S_.nodes; }
+    // Search counters of the last call (all zero but nodes if built without
+    // CPPSOLVER_STATS or with Engine::Band).
+    const SolverStats& stats() const { return S_.stats; }
+    // Per-stage inference cost of the last call (cell engine only).
+    const InferenceStats& inference_stats() const { return S_.inference_stats; }
+    // Dead-state table probes of the last call (SolverConfig::tt_mb).
+    const TTStats& tt_stats() const { return S_.tt_stats; }
+    // With SolverConfig::portfolio: the race of the last solve, if one ran.
+    const PortfolioStats& portfolio_stats() const { return portfolio_stats_; }
+    // Hits/misses of the result cache (SolverConfig::cache_entries); zero
+    // without one. After a hit, nodes() and stats() are zero and only
+    // cell_value in state() is meaningful.
+    CacheStats cache_stats() const { return cache_ ? cache_->stats() : CacheStats{}; }
+    void set_config(const SolverConfig& cfg);
 
 private:
+    void size_snapshots();
+    // rec (if set) is the packed form of puzzle and seeds the state.
+    bool solve_impl(std::string_view puzzle, const uint8_t* rec, SolverTimings* timings);
+    bool solve_cached(std::string_view puzzle, const uint8_t* rec, SolverTimings* timings);
+    int count_impl(std::string_view puzzle, const uint8_t* rec, int limit);
+    void finish_stats();
+    void arm_limits(); // copy config_.limits into S_ and band_, starting the clock
+
     SolverState S_;
     Trail trail_;
     SolverConfig config_{};
+    BandEngine band_;
+    std::unique_ptr<SolveCache> cache_;
+    std::shared_ptr<TranspositionTable> tt_;
+    SolveResult result_ = SolveResult::Unsolved;
+    PortfolioStats portfolio_stats_{};
 };
@@ -1,10 +1,14 @@
 #pragma once
 #include <array>
+#include <atomic>
 #include <vector>
-#include <string>
+#include <string_view>
 #include <cstdint>
 #include "geometry.hpp"
 #include "config.hpp"
+#include "inference.hpp"
+#include "stats.hpp"
+#include "transposition.hpp"
 
 struct Trail; // forward
 
@@ -18,6 +22,13 @@ struct SolverState {
     // Current value in each cell: 0 if empty, else 1..9
     std::array<uint8_t, 81> cell_value{};
 
+    // Cells with cell_value == 0, as a bitboard (kept by place_digit/undo_to)
+    geom::Bits81 open{};
+
+    // MRV buckets: mrv_bucket[k] = open cells with exactly k candidates (0..9).
+    // Maintained by eliminate_digit/place_digit and reverted by Trail::undo_to.
+    std::array<geom::Bits81, 10> mrv_bucket{};
+
     // Unit-digit counts [27 units][9 digits]
     int unit_digit_count[27][9]{};
 
@@ -26,7 +37,7 @@ struct SolverState {
     std::vector<int> q_l1;   // hidden singles: encode (unit<<4)|digit (digit 0..8)
     std::vector<int> q_lock; // lock events: encode (box<<4)|digit
 
-    // Enqueue flags (optional churn control)
+    // Enqueue flags (churn control): set exactly while the event is queued
     std::array<uint8_t, 81> enq_l4{};
     std::array<uint8_t, 27*9> enq_l1{};    // index = unit*9 + digit
     std::array<uint8_t, 9*9> enq_lock{};   // index = box*9 + digit
@@ -39,12 +50,84 @@ struct SolverState {
 
     int last_prop_placements = 0;
 
+    // DFS nodes visited for the current puzzle (reset by init_from_puzzle)
+    uint64_t nodes = 0;
+
+    // Search counters for the current puzzle (only updated when cfg::kStats;
+    // reset by init_from_puzzle, nodes/trail_peak filled in by the owner)
+    SolverStats stats{};
+
+    // Inference stage costs for the current puzzle (reset by init_from_puzzle)
+    InferenceStats inference_stats{};
+
+    // Nonzero => dfs_single tries each cell's candidates in random order
+    // (xorshift64* state, advanced by next_random). Set by the owner.
+    uint64_t rng = 0;
+
+    // The DFS gives up (returns false with aborted set, the state rolled
+    // back) once nodes reaches node_limit, the trail reaches trail_limit,
+    // timing::ticks() passes deadline (looked at every 1024 nodes) or *stop
+    // becomes true; zero/null disables each. Set by the owner; aborted is
+    // reset by init_from_puzzle.
+    uint64_t node_limit = 0;
+    size_t trail_limit = 0;
+    uint64_t deadline = 0;
+    const std::atomic<bool>* stop = nullptr;
+    bool aborted = false;
+
+    // Branching::Wdeg: conflict weight per unit. eliminate_digit/place_digit
+    // add wdeg_bump to the units of every contradiction they find (a unit
+    // left without a digit, or a cell without candidates), and the bump grows
+    // by 1/wdeg_decay per conflict so that old conflicts fade. Kept across
+    // backtracking, reset by init_from_puzzle.
+    bool wdeg = false;          // set by owner
+    float wdeg_decay = 0.95f;   // set by owner
+    float wdeg_bump = 1.0f;
+    std::array<float, 27> unit_weight{};
+
+    // Zobrist hash of the placements (transposition.hpp), kept by
+    // place_digit, Trail::undo_to and the snapshots. With tt set, the DFS
+    // skips states whose hash is in the table and adds every state it has
+    // searched to the end without a solution; tt_stats counts both (reset by
+    // init_from_puzzle).
+    uint64_t hash = 0;
+    TranspositionTable* tt = nullptr; // set by owner
+    TTStats tt_stats{};
+
     Trail* trail = nullptr; // set by owner
+    BoardBackend boards = BoardBackend::Scalar; // set by owner from SolverConfig
+    const InferenceConfig* inference = nullptr; // set by owner; null => singles/pointing only
 
     void reset();
-    void init_from_puzzle(const std::string& puzzle); // '.' or '0' means empty
+    void init_from_puzzle(std::string_view puzzle); // '.' or '0' means empty
+    void init_from_packed(const uint8_t* rec);      // one packed::kRecordBytes record
     bool is_solved() const;
+
+private:
+    // Bitboards, counters and queues from cell_mask (givens are singletons).
+    void init_from_masks();
 };
 
 // Utility
 inline int popcount9(uint16_t m){ return __builtin_popcount((unsigned)m); }
+
+// xorshift64* step; s must be nonzero.
+inline uint64_t next_random(uint64_t& s){
+    s ^= s >> 12; s ^= s << 25; s ^= s >> 27;
+    return s * 0x2545F4914F6CDD1Dull;
+}
+
+// Grow the wdeg bump after a conflict, rescaling everything before it overflows.
+inline void note_conflict(SolverState& S){
+    S.wdeg_bump /= S.wdeg_decay;
+    if(S.wdeg_bump > 1e30f){
+        for(float& w : S.unit_weight) w *= 1e-30f;
+        S.wdeg_bump *= 1e-30f;
+    }
+}
+
+// Move open cell c between MRV buckets after its mask changed from `from` to `to`.
+inline void mrv_move(SolverState& S, int c, uint16_t from, uint16_t to){
+    geom::clr_bit(S.mrv_bucket[popcount9(from)], c);
+    geom::set_bit(S.mrv_bucket[popcount9(to)], c);
+}
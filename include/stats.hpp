@@ -0,0 +1,32 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+
+// Search counters for one solve/count call (SudokuSolver::stats()). Only
+// collected when cfg::kStats is true (CMake option CPPSOLVER_STATS); the
+// increments sit behind `if constexpr` and vanish otherwise.
+struct SolverStats {
+    uint64_t nodes = 0;            // DFS nodes
+    uint64_t max_depth = 0;        // deepest DFS level that branched
+    uint64_t backtracks = 0;       // rollbacks of a failed candidate
+    uint64_t place_calls = 0;      // place_digit
+    uint64_t elim_calls = 0;       // eliminate_digit
+    uint64_t lock_events = 0;      // lock queue entries processed
+    uint64_t lock_productive = 0;  // ... that eliminated at least one candidate
+    uint64_t trail_peak = 0;       // trail high-water mark (entries)
+    uint64_t py_fires = 0;         // dual search: should_use_py accepted a px branch
+
+    // Sums counters; max_depth and trail_peak keep the maximum.
+    SolverStats& operator+=(const SolverStats& o){
+        nodes += o.nodes;
+        max_depth = std::max(max_depth, o.max_depth);
+        backtracks += o.backtracks;
+        place_calls += o.place_calls;
+        elim_calls += o.elim_calls;
+        lock_events += o.lock_events;
+        lock_productive += o.lock_productive;
+        trail_peak = std::max(trail_peak, o.trail_peak);
+        py_fires += o.py_fires;
+        return *this;
+    }
+};
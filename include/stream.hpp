@@ -0,0 +1,26 @@
+#pragma once
+#include <cstddef>
+#include "config.hpp"
+
+struct StreamOptions {
+    int in_fd = 0;
+    int out_fd = 1;
+    size_t batch = 64;      // while more input is waiting, flush after this many answers...
+    int flush_ms = 10;      // ...or once the oldest unflushed answer is this old
+    int count_limit = 0;    // >0 => answer with the solution count (as --count)
+    size_t max_line = 1024; // longer lines are answered with kLineTooLongText
+};
+
+struct StreamResult {
+    size_t puzzles = 0;
+    size_t solved = 0;      // count mode: unique
+    bool io_ok = true;
+};
+
+// Co-process mode: read puzzles from in_fd as they arrive, solve each with one
+// persistent SudokuSolver and write one answer line per puzzle line (blank
+// lines and '#' comments get none). Answers are written as soon as no more
+// input is waiting, so a caller can wait on each answer through a pipe; while
+// input keeps coming they are batched, but never held longer than flush_ms.
+// Input memory is bounded by max_line: the rest of a longer line is skipped.
+StreamResult run_stream(const SolverConfig& cfg, const StreamOptions& opt);
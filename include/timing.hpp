@@ -0,0 +1,81 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define CPPSOLVER_HAVE_TSC 1
+#endif
+
+// Clocks for --timings and the benchmarks.
+//
+// Per-puzzle intervals use the TSC (a few ns to read, no syscall); CPU time
+// comes from clock_gettime CPU clocks, which do enter the kernel, so they are
+// read once per batch (or per phase only when --timings asks for it).
+namespace timing {
+
+// CLOCK_MONOTONIC_RAW: not slewed by NTP, served from the vDSO.
+inline uint64_t mono_ns(){
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+inline uint64_t thread_cpu_ns(){
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+inline uint64_t process_cpu_ns(){
+    timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+// Interval counter: TSC where available (assumed invariant), else mono_ns().
+inline uint64_t ticks(){
+#ifdef CPPSOLVER_HAVE_TSC
+    return __rdtsc();
+#else
+    return mono_ns();
+#endif
+}
+
+// Nanoseconds per tick, calibrated against CLOCK_MONOTONIC_RAW on first use
+// (spins for ~2 ms once per process).
+double ns_per_tick();
+
+inline uint64_t ticks_to_ns(uint64_t t){ return (uint64_t)((double)t * ns_per_tick()); }
+inline double ns_to_ms(uint64_t ns){ return (double)ns / 1e6; }
+inline double ticks_to_ms(uint64_t t){ return ns_to_ms(ticks_to_ns(t)); }
+
+// Per-puzzle latency samples: exact percentiles over all samples plus a
+// log2 histogram (bucket k counts samples in [2^k, 2^(k+1)) ns; 0 goes to 0).
+class LatencyHistogram {
+public:
+    void reserve(size_t n){ samples_.reserve(n); }
+    void add(uint64_t ns){
+        samples_.push_back(ns);
+        sorted_ = false;
+        ++buckets_[ns ? 63 - __builtin_clzll(ns) : 0];
+    }
+    void merge(const LatencyHistogram& o);
+
+    size_t count() const { return samples_.size(); }
+    // Nearest-rank percentile, p in [0, 100]; 0 when empty.
+    uint64_t percentile(double p);
+    uint64_t max();
+    const std::array<uint64_t, 64>& buckets() const { return buckets_; }
+
+private:
+    void sort();
+
+    std::vector<uint64_t> samples_;
+    std::array<uint64_t, 64> buckets_{};
+    bool sorted_ = true;
+};
+
+} // namespace timing
@@ -1,10 +1,9 @@
 #pragma once
+#include <array>
 #include <vector>
 #include <cstdint>
-<<<<<<< HEAD
 #include <cstddef>
-=======
->>>>>>> origin/main
+#include "geometry.hpp"
 
 struct SolverState;
 
@@ -17,8 +16,22 @@ struct TrailEntry {
     uint16_t old_mask;   // previous cell_mask[cell]
 };
 
+// Copy of everything in SolverState that a branch can change, restored with
+// plain memcpy (RestoreMode::Snapshot / Hybrid). Cache-line aligned so each
+// stack slot starts on its own line.
+struct alignas(64) StateSnapshot {
+    std::array<geom::Bits81, 9> B;
+    std::array<geom::Bits81, 10> mrv_bucket;
+    geom::Bits81 open;
+    int unit_digit_count[27][9];
+    std::array<uint16_t, 81> cell_mask;
+    std::array<uint8_t, 81> cell_value;
+    uint64_t hash;
+};
+
 struct Trail {
     std::vector<TrailEntry> log;
+    std::vector<StateSnapshot> snapshots; // one slot per DFS depth (preallocated)
     void reserve(size_t n){ log.reserve(n); }
     inline size_t mark() const { return log.size(); }
 
@@ -30,4 +43,10 @@ struct Trail {
     }
 
     void undo_to(SolverState& S, size_t to_index);
+
+    // Snapshot stack: save the state at `level`, later restore it and drop
+    // the log entries above `to_index` without replaying them.
+    int snapshot_levels() const { return (int)snapshots.size(); }
+    void save_snapshot(const SolverState& S, int level);
+    void restore_snapshot(SolverState& S, int level, size_t to_index);
 };
@@ -0,0 +1,94 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// Zobrist keys for placements: SolverState::hash is the XOR of key(c, d) over
+// every placed cell (place_digit adds, Trail::undo_to removes).
+namespace zobrist {
+namespace detail {
+constexpr uint64_t splitmix64(uint64_t& s){
+    uint64_t z = (s += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+constexpr std::array<uint64_t, 81 * 9> make_keys(){
+    std::array<uint64_t, 81 * 9> k{};
+    uint64_t s = 0x5D0C5EEDull;
+    for(auto& v : k) v = splitmix64(s);
+    return k;
+}
+} // namespace detail
+
+inline constexpr std::array<uint64_t, 81 * 9> kKeys = detail::make_keys();
+
+inline uint64_t key(int cell, int digit){ return kKeys[cell * 9 + digit]; }
+} // namespace zobrist
+
+// Probes and results of the dead-state table for one solve (summed by the
+// batch runners).
+struct TTStats {
+    uint64_t probes = 0;
+    uint64_t hits = 0;       // probes that pruned a subtree
+    uint64_t stores = 0;
+
+    TTStats& operator+=(const TTStats& o){
+        probes += o.probes;
+        hits += o.hits;
+        stores += o.stores;
+        return *this;
+    }
+};
+
+// Fixed-size, lossy set of placement hashes whose subtree holds no solution
+// (SolverConfig::tt_mb). Propagation only ever removes candidates that no
+// solution can use, so whether a set of placements extends to a solution
+// depends on the set alone: entries stay valid across search orders, across
+// threads and across puzzles (the givens are placements too).
+//
+// Four-way buckets of 64-bit keys; a full bucket overwrites a slot chosen by
+// the key's top bits, and 0 marks an empty slot (a hash of 0 is never
+// stored). Slots are relaxed atomics so that parallel_dfs and portfolio_dfs
+// workers can share one table; two racing stores at worst lose an entry.
+class TranspositionTable {
+public:
+    explicit TranspositionTable(size_t mb);
+
+    bool contains(uint64_t h) const{
+        if(!h) return false;
+        const std::atomic<uint64_t>* b = bucket(h);
+        for(int i = 0; i < kWays; ++i)
+            if(b[i].load(std::memory_order_relaxed) == h) return true;
+        return false;
+    }
+
+    void insert(uint64_t h){
+        if(!h) return;
+        std::atomic<uint64_t>* b = bucket(h);
+        for(int i = 0; i < kWays; ++i){
+            uint64_t v = b[i].load(std::memory_order_relaxed);
+            if(v == h) return;
+            if(!v){
+                b[i].store(h, std::memory_order_relaxed);
+                return;
+            }
+        }
+        b[h >> 62].store(h, std::memory_order_relaxed);
+    }
+
+    size_t mb() const { return mb_; } // as requested; bytes() may be less
+    size_t bytes() const { return (mask_ + 1) * kWays * sizeof(uint64_t); }
+
+private:
+    static constexpr int kWays = 4;
+
+    std::atomic<uint64_t>* bucket(uint64_t h) const{ return slots_.get() + (h & mask_) * kWays; }
+
+    std::unique_ptr<std::atomic<uint64_t>[]> slots_;
+    uint64_t mask_ = 0; // buckets - 1
+    size_t mb_ = 0;
+};
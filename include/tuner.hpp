@@ -0,0 +1,50 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <vector>
+#include "batch.hpp"
+#include "config.hpp"
+
+// Offline search over SolverConfig::dual and SolverConfig::scoring
+// (`cppsolver tune`). Every candidate solves the puzzles sequentially on its
+// own SudokuSolver; candidates run in parallel.
+enum class TuneMethod : uint8_t {
+    Random,   // `trials` random candidates, each on every puzzle
+    Grid,     // a fixed coarse grid (trials is ignored)
+    Halving,  // successive halving: `trials` random candidates on a small
+              // prefix of the puzzles, the better half moves on to twice as many
+};
+
+enum class TuneObjective : uint8_t { Nodes, Time };
+
+struct TuneOptions {
+    TuneMethod method = TuneMethod::Halving;
+    TuneObjective objective = TuneObjective::Nodes;
+    size_t trials = 32;
+    int threads = 0;          // candidates evaluated at once, 0 => all cores
+    uint64_t seed = 1;
+    std::ostream* log = nullptr; // one line per round, if set
+};
+
+// One candidate's totals over the puzzles it was run on.
+struct TuneScore {
+    size_t puzzles = 0;
+    size_t timeouts = 0;      // stopped by SolverConfig::limits
+    uint64_t nodes = 0;
+    double cpu_ms = 0.0;      // thread CPU time, so parallel candidates don't skew it
+};
+
+struct TuneResult {
+    SolverConfig best{};
+    TuneScore best_score{};
+    TuneScore baseline{};     // the config tune() started from, same puzzles
+    size_t evaluated = 0;     // candidate runs over all rounds
+    double wall_ms = 0.0;
+};
+
+// The config passed in is candidate 0 and survives every halving round; the
+// result is it unless a candidate strictly beats it on the final round's
+// puzzles, so it is never worse there. Candidates are ranked by timeouts,
+// then by the objective, then by the other measure.
+TuneResult tune(const std::vector<BatchPuzzle>& puzzles, const SolverConfig& base, const TuneOptions& opt);
@@ -0,0 +1,30 @@
+#pragma once
+#include <deque>
+#include <mutex>
+
+// Per-worker deque for work stealing: the owner pops from the front (in the
+// order items were pushed), thieves take from the back so they rarely
+// contend with the owner.
+template <class T>
+class WorkQueue {
+public:
+    void push(const T& item){
+        std::lock_guard<std::mutex> lk(m_);
+        q_.push_back(item);
+    }
+    bool pop(T& out){
+        std::lock_guard<std::mutex> lk(m_);
+        if(q_.empty()) return false;
+        out = q_.front(); q_.pop_front();
+        return true;
+    }
+    bool steal(T& out){
+        std::lock_guard<std::mutex> lk(m_);
+        if(q_.empty()) return false;
+        out = q_.back(); q_.pop_back();
+        return true;
+    }
+private:
+    std::mutex m_;
+    std::deque<T> q_;
+};
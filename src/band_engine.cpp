@@ -0,0 +1,257 @@
+#include "band_engine.hpp"
+#include "timing.hpp"
+#if defined(__BMI2__)
+#include <immintrin.h>
+#endif
+
+namespace {
+
+constexpr uint32_t ALL27 = (1u << 27) - 1u;
+constexpr uint32_t ROW_BITS = 0x1FFu;          // row 0 of a band; << 9*i
+constexpr uint32_t BOX_BITS = 0x1C0E07u;       // box 0 of a band; << 3*k
+constexpr uint32_t COL_BITS = 0x40201u;        // column 0 of a band; << c
+constexpr uint32_t SEG_LSB  = 0x1249249u;      // lowest bit of each 3-cell segment
+
+// Segment (row_in_band i, box_in_band k) is bit i*3+k of a 9-bit pattern.
+// Pointing and claiming inside a band reduce a pattern to the segments that
+// can still hold the digit; iterate both rules to a fixpoint per pattern.
+constexpr std::array<uint16_t, 512> make_locked_table(){
+    std::array<uint16_t, 512> t{};
+    for(unsigned p = 0; p < 512; ++p){
+        unsigned s = p;
+        while(true){
+            unsigned prev = s;
+            for(int k = 0; k < 3; ++k){ // box k confined to one row => clear that row elsewhere
+                unsigned rows = 0;
+                for(int i = 0; i < 3; ++i) if(s >> (i*3+k) & 1u) rows |= 1u << i;
+                if(rows && !(rows & (rows - 1))){
+                    int i = rows == 1 ? 0 : rows == 2 ? 1 : 2;
+                    s &= ~(7u << (i*3)) | (1u << (i*3+k));
+                }
+            }
+            for(int i = 0; i < 3; ++i){ // row i confined to one box => clear that box elsewhere
+                unsigned boxes = (s >> (i*3)) & 7u;
+                if(boxes && !(boxes & (boxes - 1))){
+                    int k = boxes == 1 ? 0 : boxes == 2 ? 1 : 2;
+                    s &= ~(0x49u << k) | (1u << (i*3+k));
+                }
+            }
+            if(s == prev) break;
+        }
+        t[p] = (uint16_t)s;
+    }
+    return t;
+}
+constexpr std::array<uint16_t, 512> LOCKED = make_locked_table();
+
+// 27-bit band word -> 9-bit segment occupancy, and back (3 cells per segment).
+inline unsigned segments(uint32_t w){
+    uint32_t t = (w | (w >> 1) | (w >> 2)) & SEG_LSB;
+#if defined(__BMI2__)
+    return _pext_u32(t, SEG_LSB);
+#else
+    unsigned s = 0;
+    for(int j = 0; j < 9; ++j) s |= ((t >> (3*j)) & 1u) << j;
+    return s;
+#endif
+}
+inline uint32_t expand_segments(unsigned s){
+#if defined(__BMI2__)
+    return _pdep_u32(s, SEG_LSB) * 7u;
+#else
+    uint32_t t = 0;
+    for(int j = 0; j < 9; ++j) t |= ((s >> j) & 1u) << (3*j);
+    return t * 7u;
+#endif
+}
+
+inline uint32_t& word(BandState& s, int d, int b){ return s.cand[d*3 + b]; }
+
+// Fix digit d at bit p of band b. False if d is no longer a candidate there.
+inline bool place(BandState& s, int b, int p, int d){
+    const uint32_t bit = 1u << p;
+    if(!(word(s, d, b) & bit)) return false;
+    const int row = p / 9, col = p % 9;
+    for(int e = 0; e < 9; ++e) word(s, e, b) &= ~bit;
+    word(s, d, b) &= ~((ROW_BITS << (row*9)) | (BOX_BITS << ((col/3)*3)) | (COL_BITS << col));
+    word(s, d, b) |= bit;
+    for(int ob = 0; ob < 3; ++ob) if(ob != b) word(s, d, ob) &= ~(COL_BITS << col);
+    s.solved[b] |= bit;
+    return true;
+}
+
+inline int digit_at(const BandState& s, int b, int p){
+    for(int d = 0; d < 9; ++d) if(s.cand[d*3 + b] >> p & 1u) return d;
+    return -1;
+}
+
+// Naked singles, hidden singles (row/box/col) and band-local locked candidates
+// to a fixpoint. False on contradiction.
+bool propagate(BandState& s){
+    bool changed = true;
+    while(changed){
+        changed = false;
+
+        // Naked singles: bit-sliced "seen once / seen twice" over the 9 digits.
+        for(int b = 0; b < 3; ++b){
+            uint32_t ones = 0, twos = 0;
+            for(int d = 0; d < 9; ++d){
+                uint32_t w = s.cand[d*3 + b];
+                twos |= ones & w;
+                ones |= w;
+            }
+            if(ones != ALL27) return false; // some cell has no candidate
+            uint32_t singles = ones & ~twos & ~s.solved[b];
+            while(singles){
+                int p = __builtin_ctz(singles);
+                singles &= singles - 1;
+                int d = digit_at(s, b, p);
+                if(d < 0 || !place(s, b, p, d)) return false;
+                changed = true;
+            }
+        }
+
+        for(int d = 0; d < 9; ++d){
+            // Hidden singles in rows and boxes of each band.
+            for(int b = 0; b < 3; ++b){
+                for(int i = 0; i < 3; ++i){
+                    uint32_t r = word(s, d, b) & (ROW_BITS << (i*9));
+                    if(!r) return false;
+                    if(!(r & (r - 1)) && !(r & s.solved[b])){
+                        if(!place(s, b, __builtin_ctz(r), d)) return false;
+                        changed = true;
+                    }
+                    uint32_t x = word(s, d, b) & (BOX_BITS << (i*3));
+                    if(!x) return false;
+                    if(!(x & (x - 1)) && !(x & s.solved[b])){
+                        if(!place(s, b, __builtin_ctz(x), d)) return false;
+                        changed = true;
+                    }
+                }
+            }
+            // Hidden singles in columns: fold the 9 grid rows as 9-bit column masks.
+            uint32_t ones = 0, twos = 0;
+            for(int b = 0; b < 3; ++b){
+                uint32_t w = word(s, d, b);
+                for(int i = 0; i < 3; ++i){
+                    uint32_t r = (w >> (i*9)) & ROW_BITS;
+                    twos |= ones & r;
+                    ones |= r;
+                }
+            }
+            if(ones != ROW_BITS) return false;
+            uint32_t single_cols = ones & ~twos;
+            while(single_cols){
+                int c = __builtin_ctz(single_cols);
+                single_cols &= single_cols - 1;
+                for(int b = 0; b < 3; ++b){
+                    uint32_t x = word(s, d, b) & (COL_BITS << c);
+                    if(!x) continue;
+                    if(!(x & s.solved[b])){
+                        if(!place(s, b, __builtin_ctz(x), d)) return false;
+                        changed = true;
+                    }
+                    break;
+                }
+            }
+            // Pointing/claiming inside each band via the segment table.
+            for(int b = 0; b < 3; ++b){
+                uint32_t w = word(s, d, b);
+                unsigned seg = segments(w);
+                unsigned keep = LOCKED[seg];
+                if(keep != seg){
+                    word(s, d, b) = w & expand_segments(keep);
+                    changed = true;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+void extract(const BandState& s, uint8_t out[81]){
+    for(int b = 0; b < 3; ++b){
+        for(int d = 0; d < 9; ++d){
+            uint32_t w = s.cand[d*3 + b] & s.solved[b];
+            while(w){
+                int p = __builtin_ctz(w);
+                w &= w - 1;
+                out[b*27 + p] = (uint8_t)(d + 1);
+            }
+        }
+    }
+}
+
+} // namespace
+
+bool BandEngine::init(std::string_view puzzle, BandState& s){
+    for(auto& w : s.cand) w = ALL27;
+    s.solved = {0, 0, 0};
+    for(int i = 0; i < 81 && i < (int)puzzle.size(); ++i){
+        char ch = puzzle[i];
+        if(ch < '1' || ch > '9') continue;
+        if(!place(s, i / 27, i % 27, ch - '1')) return false;
+    }
+    return true;
+}
+
+bool BandEngine::search(BandState& s, int limit, int& found, uint8_t out[81]){
+    ++nodes_;
+    if(!propagate(s)) return false;
+    if((s.solved[0] & s.solved[1] & s.solved[2]) == ALL27){
+        extract(s, out);
+        return ++found >= limit;
+    }
+    // Out of budget: report "done" so every level unwinds at once.
+    if((max_nodes_ && nodes_ > max_nodes_) ||
+       (deadline_ && (nodes_ & 1023) == 0 && timing::ticks() >= deadline_)){
+        aborted_ = true;
+        return true;
+    }
+
+    // Branch on the open cell with the fewest candidates (bit-sliced counts).
+    int best_b = -1, best_p = -1, best_n = 10;
+    for(int b = 0; b < 3 && best_n > 2; ++b){
+        uint32_t p0 = 0, p1 = 0, p2 = 0, p3 = 0;
+        for(int d = 0; d < 9; ++d){
+            uint32_t x = s.cand[d*3 + b];
+            uint32_t c0 = p0 & x;  p0 ^= x;
+            uint32_t c1 = p1 & c0; p1 ^= c0;
+            uint32_t c2 = p2 & c1; p2 ^= c1;
+            p3 |= c2;
+        }
+        uint32_t open = ALL27 & ~s.solved[b];
+        for(int k = 2; k < best_n; ++k){
+            uint32_t m = open & ((k & 1) ? p0 : ~p0) & ((k & 2) ? p1 : ~p1)
+                              & ((k & 4) ? p2 : ~p2) & ((k & 8) ? p3 : ~p3);
+            if(m){
+                best_b = b; best_p = __builtin_ctz(m); best_n = k;
+                break;
+            }
+        }
+    }
+    if(best_b < 0) return false;
+
+    for(int d = 0; d < 9; ++d){
+        if(!(word(s, d, best_b) >> best_p & 1u)) continue;
+        BandState t = s;
+        if(!place(t, best_b, best_p, d)) continue;
+        if(search(t, limit, found, out)) return true;
+    }
+    return false;
+}
+
+bool BandEngine::solve(std::string_view puzzle, uint8_t out[81]){
+    return count(puzzle, 1, out) >= 1;
+}
+
+int BandEngine::count(std::string_view puzzle, int limit, uint8_t out[81]){
+    nodes_ = 0;
+    aborted_ = false;
+    if(limit <= 0) return 0;
+    BandState s;
+    if(!init(puzzle, s)) return 0;
+    int found = 0;
+    search(s, limit, found, out);
+    return found;
+}
@@ -0,0 +1,194 @@
+#include "batch.hpp"
+#include "solver.hpp"
+#include "output_buffer.hpp"
+#include "timing.hpp"
+#include "work_queue.hpp"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace {
+// Half-open range of puzzle indices.
+struct Chunk {
+    size_t begin;
+    size_t end;
+};
+
+constexpr size_t kSolutionWidth = 81;
+constexpr size_t kOrderedWindow = 4; // chunks per worker ahead of the printer
+} // namespace
+
+BatchResult run_batch(const std::vector<BatchPuzzle>& puzzles,
+                      const SolverConfig& cfg,
+                      const BatchOptions& opt){
+    const size_t n = puzzles.size();
+    int threads = opt.threads;
+    if(threads <= 0) threads = (int)std::max(1u, std::thread::hardware_concurrency());
+    const size_t chunk = std::max<size_t>(1, opt.chunk);
+    const size_t num_chunks = (n + chunk - 1) / chunk;
+    threads = (int)std::max<size_t>(1, std::min<size_t>((size_t)threads, std::max<size_t>(1, num_chunks)));
+
+    // Ordered printing claims chunks from next_chunk in file order. Otherwise
+    // deal contiguous blocks of chunks so each worker starts on its own slice.
+    const bool ordered_print = opt.print && opt.ordered;
+    std::atomic<size_t> next_chunk{0};
+    std::vector<WorkQueue<Chunk>> queues(threads);
+    for(size_t ci = 0; !ordered_print && ci < num_chunks; ++ci){
+        size_t owner = ci * (size_t)threads / num_chunks;
+        size_t b = ci * chunk;
+        queues[owner].push(Chunk{b, std::min(n, b + chunk)});
+    }
+
+    // Under out_mu: finished chunks waiting for earlier ones, and the next
+    // chunk to print.
+    const int limit = opt.count_limit;
+    std::mutex out_mu;
+    std::condition_variable printed_cv;
+    std::map<size_t, std::string> pending;
+    size_t printed = 0;
+    OutputBuffer out(1, ordered_print ? 1 << 20 : 256);
+    bool output_ok = true;
+
+    BatchResult res;
+    res.puzzles = n;
+    res.count_limit = limit;
+    res.per_thread.assign(threads, BatchThreadStats{});
+
+    std::vector<timing::LatencyHistogram> latency(opt.record_latency ? threads : 0);
+
+    // One dead-state table for all workers, like parallel_dfs: entries hold
+    // across puzzles, and tt_mb stays the whole budget.
+    std::shared_ptr<TranspositionTable> tt;
+    if(cfg.tt_mb) tt = std::make_shared<TranspositionTable>(cfg.tt_mb);
+
+    auto worker = [&](int id){
+        SudokuSolver solver(cfg, tt);
+        BatchThreadStats& st = res.per_thread[id];
+        timing::LatencyHistogram* lat = opt.record_latency ? &latency[id] : nullptr;
+        if(lat) lat->reserve(n / threads + chunk);
+        // Each worker formats a chunk locally. Unordered mode writes it with
+        // one write(2) while holding the output lock; ordered mode hands it
+        // to the printer. Sized so a whole chunk fits and no flush can happen
+        // outside the lock.
+        OutputBuffer local_out(1, opt.print ? chunk * 128 : 256);
+        Chunk c{};
+        size_t ci = 0;
+        while(true){
+            if(ordered_print){
+                ci = next_chunk.fetch_add(1, std::memory_order_relaxed);
+                if(ci >= num_chunks) break;
+                c = Chunk{ci * chunk, std::min(n, ci * chunk + chunk)};
+                // The chunk at `printed` is always held by a worker that is
+                // not waiting, so this cannot deadlock.
+                std::unique_lock<std::mutex> lk(out_mu);
+                printed_cv.wait(lk, [&]{ return ci < printed + kOrderedWindow * (size_t)threads; });
+            }else{
+                bool got = queues[id].pop(c);
+                for(int k = 1; !got && k < threads; ++k){
+                    got = queues[(id + k) % threads].steal(c);
+                    if(got) ++st.steals;
+                }
+                if(!got) break;
+            }
+
+            const uint64_t chunk_t0 = timing::ticks();
+            for(size_t i = c.begin; i < c.end; ++i){
+                const uint64_t t0 = lat ? timing::ticks() : 0;
+                if(limit > 0){
+                    const BatchPuzzle& p = puzzles[i];
+                    int cnt = p.packed ? solver.count_solutions_packed(p.packed, limit)
+                                       : solver.count_solutions(p.text, limit);
+                    if(lat) lat->add(timing::ticks_to_ns(timing::ticks() - t0));
+                    st.nodes += solver.nodes();
+                    st.stats += solver.stats();
+                    st.inference += solver.inference_stats();
+                    st.tt += solver.tt_stats();
+                    const bool timeout = solver.result() == SolveResult::Timeout;
+                    ++st.puzzles;
+                    if(cnt >= 1) ++st.solved;
+                    if(cnt == 1 && !timeout) ++st.unique;
+                    if(timeout) ++st.timeouts;
+                    if(!opt.print) continue;
+                    if(!opt.ordered){
+                        local_out.append_uint(puzzles[i].line);
+                        local_out.put(' ');
+                    }
+                    if(timeout) local_out.append(kTimeoutText);
+                    else append_count(local_out, cnt, limit);
+                    local_out.put('\n');
+                    continue;
+                }
+                const BatchPuzzle& p = puzzles[i];
+                bool ok = p.packed ? solver.solve_packed(p.packed) : solver.solve(p.text);
+                if(lat) lat->add(timing::ticks_to_ns(timing::ticks() - t0));
+                st.nodes += solver.nodes();
+                st.stats += solver.stats();
+                st.inference += solver.inference_stats();
+                st.tt += solver.tt_stats();
+                ++st.puzzles;
+                if(ok) ++st.solved;
+                if(solver.result() == SolveResult::Timeout) ++st.timeouts;
+                st.portfolio += solver.portfolio_stats();
+                if(!opt.print) continue;
+                if(!opt.ordered){
+                    local_out.append_uint(puzzles[i].line);
+                    local_out.put(' ');
+                }
+                if(ok){
+                    solver.solution_into(local_out.reserve(kSolutionWidth));
+                    local_out.commit(kSolutionWidth);
+                }else{
+                    local_out.append(solver.result() == SolveResult::Timeout ? kTimeoutText : kUnsolvedText);
+                }
+                local_out.put('\n');
+            }
+            st.busy_ms += timing::ticks_to_ms(timing::ticks() - chunk_t0);
+            if(!opt.print) continue;
+            std::lock_guard<std::mutex> lk(out_mu);
+            if(!ordered_print){
+                if(!local_out.flush()) output_ok = false;
+                continue;
+            }
+            pending.emplace(ci, std::string(local_out.view()));
+            local_out.clear();
+            for(auto it = pending.find(printed); it != pending.end(); it = pending.find(printed)){
+                out.append(it->second);
+                pending.erase(it);
+                ++printed;
+            }
+            if(!out.flush()) output_ok = false;
+            printed_cv.notify_all();
+        }
+        st.cache = solver.cache_stats();
+    };
+
+    timing::ns_per_tick(); // calibrate before any worker starts timing
+    const uint64_t wall_start = timing::mono_ns();
+    const uint64_t cpu_start = timing::process_cpu_ns();
+    std::vector<std::thread> pool;
+    pool.reserve(threads);
+    for(int t = 0; t < threads; ++t) pool.emplace_back(worker, t);
+    for(auto& th : pool) th.join();
+    res.wall_ms = timing::ns_to_ms(timing::mono_ns() - wall_start);
+    res.cpu_ms = timing::ns_to_ms(timing::process_cpu_ns() - cpu_start);
+    for(const auto& h : latency) res.latency.merge(h);
+
+    for(const auto& st : res.per_thread){
+        res.solved += st.solved;
+        res.unique += st.unique;
+        res.timeouts += st.timeouts;
+        res.nodes += st.nodes;
+        res.stats += st.stats;
+        res.inference += st.inference;
+        res.cache += st.cache;
+        res.tt += st.tt;
+        res.portfolio += st.portfolio;
+    }
+    res.output_ok = output_ok;
+    return res;
+}
@@ -0,0 +1,155 @@
+#include "config_file.hpp"
+#include <cerrno>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string_view>
+
+namespace {
+enum class Kind : uint8_t { Bool, Int, Float };
+
+struct Key {
+    const char* name;
+    Kind kind;
+    void* (*field)(SolverConfig&);
+    int lo = 0, hi = 0; // Kind::Int: valid range
+};
+
+#define CPPSOLVER_KEY(name, kind, member) \
+    Key{name, kind, [](SolverConfig& c) -> void* { return &c.member; }}
+#define CPPSOLVER_INT_KEY(name, member, lo, hi) \
+    Key{name, Kind::Int, [](SolverConfig& c) -> void* { return &c.member; }, lo, hi}
+
+// Depths and candidate counts are bounded by the 81 cells and 9 digits.
+const Key kKeys[] = {
+    CPPSOLVER_KEY("dual.enabled", Kind::Bool, dual.enabled),
+    CPPSOLVER_INT_KEY("dual.max_mrv_px", dual.max_mrv_px, 0, 9),
+    CPPSOLVER_INT_KEY("dual.min_depth", dual.min_depth, 0, 81),
+    CPPSOLVER_INT_KEY("dual.max_depth", dual.max_depth, 0, 81),
+    CPPSOLVER_KEY("dual.require_flat_prop", Kind::Bool, dual.require_flat_prop),
+    CPPSOLVER_INT_KEY("dual.max_py_candidates", dual.max_py_candidates, 0, 9),
+    CPPSOLVER_KEY("scoring.influence", Kind::Float, scoring.influence),
+    CPPSOLVER_KEY("scoring.scarcity", Kind::Float, scoring.scarcity),
+    CPPSOLVER_KEY("scoring.shared_units", Kind::Float, scoring.shared_units),
+    CPPSOLVER_KEY("scoring.overlap", Kind::Float, scoring.overlap),
+    CPPSOLVER_KEY("scoring.mrv", Kind::Float, scoring.mrv),
+};
+#undef CPPSOLVER_KEY
+#undef CPPSOLVER_INT_KEY
+
+std::string_view trim(std::string_view s){
+    while(!s.empty() && (s.front() == ' ' || s.front() == '\t')) s.remove_prefix(1);
+    while(!s.empty() && (s.back() == ' ' || s.back() == '\t' || s.back() == '\r')) s.remove_suffix(1);
+    return s;
+}
+
+bool parse_value(const Key& k, const std::string& v, SolverConfig& cfg){
+    void* p = k.field(cfg);
+    char* end = nullptr;
+    switch(k.kind){
+    case Kind::Bool:
+        if(v == "true" || v == "1") *static_cast<bool*>(p) = true;
+        else if(v == "false" || v == "0") *static_cast<bool*>(p) = false;
+        else return false;
+        return true;
+    case Kind::Int: {
+        errno = 0;
+        long x = std::strtol(v.c_str(), &end, 10);
+        if(v.empty() || *end || errno == ERANGE || x < k.lo || x > k.hi) return false;
+        *static_cast<int*>(p) = (int)x;
+        return true;
+    }
+    case Kind::Float: {
+        errno = 0;
+        float x = std::strtof(v.c_str(), &end);
+        if(v.empty() || *end || errno == ERANGE || !std::isfinite(x)) return false;
+        *static_cast<float*>(p) = x;
+        return true;
+    }
+    }
+    return false;
+}
+
+// What parse_value accepts, for error messages.
+std::string expected(const Key& k){
+    switch(k.kind){
+    case Kind::Bool: return "true or false";
+    case Kind::Int: return "integer in " + std::to_string(k.lo) + ".." + std::to_string(k.hi);
+    case Kind::Float: return "finite number";
+    }
+    return "";
+}
+} // namespace
+
+bool load_config_file(const std::string& path, SolverConfig& cfg, std::string& err){
+    std::ifstream in(path);
+    if(!in){
+        err = path + ": " + std::strerror(errno);
+        return false;
+    }
+    std::string line;
+    int depth_line = 0; // last line setting dual.min_depth or dual.max_depth
+    for(int no = 1; std::getline(in, line); ++no){
+        std::string_view s = line;
+        if(size_t hash = s.find('#'); hash != std::string_view::npos) s = s.substr(0, hash);
+        s = trim(s);
+        if(s.empty()) continue;
+        size_t eq = s.find('=');
+        if(eq == std::string_view::npos){
+            err = path + ":" + std::to_string(no) + ": expected key = value";
+            return false;
+        }
+        std::string_view name = trim(s.substr(0, eq));
+        std::string value(trim(s.substr(eq + 1)));
+        const Key* key = nullptr;
+        for(const Key& k : kKeys) if(name == k.name) key = &k;
+        if(!key){
+            err = path + ":" + std::to_string(no) + ": unknown key " + std::string(name);
+            return false;
+        }
+        if(!parse_value(*key, value, cfg)){
+            err = path + ":" + std::to_string(no) + ": bad value for " + key->name +
+                  " (expected " + expected(*key) + ")";
+            return false;
+        }
+        if(name == "dual.min_depth" || name == "dual.max_depth") depth_line = no;
+    }
+    if(depth_line && cfg.dual.max_depth < cfg.dual.min_depth){
+        err = path + ":" + std::to_string(depth_line) + ": dual.max_depth (" +
+              std::to_string(cfg.dual.max_depth) + ") is below dual.min_depth (" +
+              std::to_string(cfg.dual.min_depth) + ")";
+        return false;
+    }
+    return true;
+}
+
+std::string format_config(const SolverConfig& cfg, const std::string& header){
+    std::ostringstream os;
+    os << header;
+    SolverConfig c = cfg;
+    for(const Key& k : kKeys){
+        void* p = k.field(c);
+        os << k.name << " = ";
+        switch(k.kind){
+        case Kind::Bool: os << (*static_cast<bool*>(p) ? "true" : "false"); break;
+        case Kind::Int: os << *static_cast<int*>(p); break;
+        case Kind::Float: os << *static_cast<float*>(p); break;
+        }
+        os << '\n';
+    }
+    return os.str();
+}
+
+bool save_config_file(const std::string& path, const SolverConfig& cfg,
+                      const std::string& header, std::string& err){
+    std::ofstream out(path, std::ios::trunc);
+    out << format_config(cfg, header);
+    out.flush();
+    if(!out){
+        err = path + ": " + std::strerror(errno);
+        return false;
+    }
+    return true;
+}
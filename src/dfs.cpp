@@ -2,9 +2,9 @@
 #include "propagation.hpp"
 #include "scoring.hpp"
 #include "trail.hpp"
+#include "timing.hpp"
 #include <algorithm>
 
-<<<<<<< HEAD
 namespace {
 // Fill cand[0..n) with digits present in a 9-bit mask.
 inline int fill_candidates(uint16_t mask, int cand[9]) {
@@ -34,13 +34,78 @@ inline void sort_candidates_desc(int cand[9], int n, ScoreFn score) {
         }
     }
 }
+
+// Fisher-Yates shuffle driven by S.rng (randomized dfs_single).
+inline void shuffle_candidates(int cand[9], int n, uint64_t& rng) {
+    for (int i = n - 1; i > 0; --i) {
+        int j = (int)(next_random(rng) % (uint64_t)(i + 1));
+        std::swap(cand[i], cand[j]);
+    }
+}
+
+// Restore point shared by all candidates of one node: the trail mark, plus a
+// snapshot slot when the restore mode copies state at this depth.
+struct Checkpoint {
+    size_t mark;
+    int level; // -1 => undo through the trail
+};
+
+inline Checkpoint checkpoint(SolverState& S, const SolverConfig& cfg, int depth) {
+    if constexpr (cfg::kStats) S.stats.max_depth = std::max<uint64_t>(S.stats.max_depth, depth);
+    Checkpoint cp{S.trail->mark(), -1};
+    bool snap = cfg.restore == RestoreMode::Snapshot ||
+                (cfg.restore == RestoreMode::Hybrid && depth < cfg.snapshot_depth);
+    if (snap && depth < S.trail->snapshot_levels()) {
+        S.trail->save_snapshot(S, depth);
+        cp.level = depth;
+    }
+    return cp;
+}
+
+inline void rollback(SolverState& S, const Checkpoint& cp) {
+    if constexpr (cfg::kStats) {
+        ++S.stats.backtracks;
+        S.stats.trail_peak = std::max<uint64_t>(S.stats.trail_peak, S.trail->mark());
+    }
+    if (cp.level >= 0) S.trail->restore_snapshot(S, cp.level, cp.mark);
+    else S.trail->undo_to(S, cp.mark);
+}
+
+// A limit reached or stop requested: latch S.aborted. The clock is read only
+// every 1024 nodes.
+inline bool should_abort(SolverState& S) {
+    if (S.aborted) return true;
+    if ((S.node_limit && S.nodes > S.node_limit) ||
+        (S.trail_limit && S.trail->mark() >= S.trail_limit) ||
+        (S.deadline && (S.nodes & 1023) == 0 && timing::ticks() >= S.deadline) ||
+        (S.stop && S.stop->load(std::memory_order_relaxed)))
+        S.aborted = true;
+    return S.aborted;
+}
+
+// SolverConfig::tt_mb: this set of placements was already searched to the
+// end without a solution.
+inline bool tt_dead(SolverState& S) {
+    if (!S.tt) return false;
+    ++S.tt_stats.probes;
+    if (!S.tt->contains(S.hash)) return false;
+    ++S.tt_stats.hits;
+    return true;
+}
+
+// Called with S back at a node whose subtree held no solution; a search cut
+// short by a limit proves nothing.
+inline void tt_store(SolverState& S) {
+    if (!S.tt || S.aborted) return;
+    S.tt->insert(S.hash);
+    ++S.tt_stats.stores;
+}
 } // namespace
 
-=======
->>>>>>> origin/main
 static bool dfs_single_node(SolverState& S, const SolverConfig& cfg, int depth);
 static bool dfs_dual_node(SolverState& S, const SolverConfig& cfg, int depth);
 static bool dfs_with_py(SolverState& S, const SolverConfig& cfg, int depth, int px);
+static bool dfs_count_node(SolverState& S, const SolverConfig& cfg, int depth, int limit, int& count);
 
 static inline bool should_use_py(const SolverState& S,
                                  const SolverConfig& cfg,
@@ -55,50 +120,52 @@ static inline bool should_use_py(const SolverState& S,
     return true;
 }
 
+int ordered_candidates(SolverState& S, const SolverConfig& cfg, int c, int cand[9]) {
+    int n = fill_candidates(S.cell_mask[c], cand);
+    if (S.rng) {
+        shuffle_candidates(cand, n, S.rng);
+    } else {
+        compute_scarcity(S);
+        sort_candidates_desc(cand, n, [&](int d){ return score_digit(S, c, d, cfg.scoring); });
+    }
+    return n;
+}
+
 bool dfs_single(SolverState& S, const SolverConfig& cfg) {
     return dfs_single_node(S, cfg, 0);
 }
 
+
 static bool dfs_single_node(SolverState& S, const SolverConfig& cfg, int depth) {
-    (void)cfg;
+    ++S.nodes;
     if (S.is_solved()) return true;
+    if (should_abort(S)) return false;
+    if (tt_dead(S)) return false;
 
     int c = select_mrv_cell(S);
     if (c < 0) return true;
 
-    uint16_t mask = S.cell_mask[c];
-<<<<<<< HEAD
     int cand[9];
-    int n = fill_candidates(mask, cand);
-    compute_scarcity(S);
-    sort_candidates_desc(cand, n, [&](int d){ return score_digit(S, c, d); });
+    int n = ordered_candidates(S, cfg, c, cand);
 
+    Checkpoint cp = checkpoint(S, cfg, depth);
     for (int i = 0; i < n; ++i) {
         int d = cand[i];
-=======
-    std::vector<int> cand; cand.reserve(9);
-    generate_candidates_from_mask(mask, cand);
-    compute_scarcity(S);
-    std::sort(cand.begin(), cand.end(), [&](int a, int b){
-        return score_digit(S, c, a) > score_digit(S, c, b);
-    });
-
-    for (int d : cand) {
->>>>>>> origin/main
-        size_t mark = S.trail->mark();
         if (!place_digit(S, c, d)) {
-            S.trail->undo_to(S, mark);
+            rollback(S, cp);
             continue;
         }
         if (!propagate(S)) {
-            S.trail->undo_to(S, mark);
+            rollback(S, cp);
             continue;
         }
         if (dfs_single_node(S, cfg, depth + 1)) {
             return true;
         }
-        S.trail->undo_to(S, mark);
+        rollback(S, cp);
+        if (S.aborted) return false;
     }
+    tt_store(S);
     return false;
 }
 
@@ -107,7 +174,10 @@ bool dfs_dual(SolverState& S, const SolverConfig& cfg) {
 }
 
 static bool dfs_dual_node(SolverState& S, const SolverConfig& cfg, int depth) {
+    ++S.nodes;
     if (S.is_solved()) return true;
+    if (should_abort(S)) return false;
+    if (tt_dead(S)) return false;
 
     int px = select_mrv_cell(S);
     if (px < 0) return true;
@@ -115,35 +185,25 @@ static bool dfs_dual_node(SolverState& S, const SolverConfig& cfg, int depth) {
     uint16_t mask_px = S.cell_mask[px];
     int mrv_px = popcount9(mask_px);
 
-<<<<<<< HEAD
     int cand_x[9];
     int nx = fill_candidates(mask_px, cand_x);
     compute_scarcity(S);
-    sort_candidates_desc(cand_x, nx, [&](int d){ return score_digit(S, px, d); });
+    sort_candidates_desc(cand_x, nx, [&](int d){ return score_digit(S, px, d, cfg.scoring); });
 
+    Checkpoint cp = checkpoint(S, cfg, depth);
     for (int ix = 0; ix < nx; ++ix) {
         int dx = cand_x[ix];
-=======
-    std::vector<int> cand_x; cand_x.reserve(9);
-    generate_candidates_from_mask(mask_px, cand_x);
-    compute_scarcity(S);
-    std::sort(cand_x.begin(), cand_x.end(), [&](int a, int b){
-        return score_digit(S, px, a) > score_digit(S, px, b);
-    });
-
-    for (int dx : cand_x) {
->>>>>>> origin/main
-        size_t mark = S.trail->mark();
         if (!place_digit(S, px, dx)) {
-            S.trail->undo_to(S, mark);
+            rollback(S, cp);
             continue;
         }
         if (!propagate(S)) {
-            S.trail->undo_to(S, mark);
+            rollback(S, cp);
             continue;
         }
 
         if (should_use_py(S, cfg, depth, mrv_px)) {
+            if constexpr (cfg::kStats) ++S.stats.py_fires;
             if (dfs_with_py(S, cfg, depth + 1, px)) {
                 return true;
             }
@@ -153,8 +213,10 @@ static bool dfs_dual_node(SolverState& S, const SolverConfig& cfg, int depth) {
             return true;
         }
 
-        S.trail->undo_to(S, mark);
+        rollback(S, cp);
+        if (S.aborted) return false;
     }
+    tt_store(S);
     return false;
 }
 
@@ -163,48 +225,78 @@ static bool dfs_with_py(SolverState& S,
                         int depth,
                         int px) {
     const DualConfig& dc = cfg.dual;
-    int py = select_pressure_cell(S, px);
+    int py = select_pressure_cell(S, px, cfg.scoring);
     if (py < 0) return false;
 
     uint16_t mask_py = S.cell_mask[py];
     if (mask_py == 0) return false;
 
-<<<<<<< HEAD
     int cand_y[9];
     int ny = fill_candidates(mask_py, cand_y);
     compute_scarcity(S);
-    sort_candidates_desc(cand_y, ny, [&](int d){ return score_digit(S, py, d); });
+    sort_candidates_desc(cand_y, ny, [&](int d){ return score_digit(S, py, d, cfg.scoring); });
 
     int limit = ny;
-=======
-    std::vector<int> cand_y; cand_y.reserve(9);
-    generate_candidates_from_mask(mask_py, cand_y);
-    compute_scarcity(S);
-    std::sort(cand_y.begin(), cand_y.end(), [&](int a, int b){
-        return score_digit(S, py, a) > score_digit(S, py, b);
-    });
-
-    int limit = static_cast<int>(cand_y.size());
->>>>>>> origin/main
     if (dc.max_py_candidates > 0) {
         limit = std::min(limit, dc.max_py_candidates);
     }
 
+    Checkpoint cp = checkpoint(S, cfg, depth);
     for (int i = 0; i < limit; ++i) {
         int dy = cand_y[i];
-        size_t mark2 = S.trail->mark();
         if (!place_digit(S, py, dy)) {
-            S.trail->undo_to(S, mark2);
+            rollback(S, cp);
             continue;
         }
         if (!propagate(S)) {
-            S.trail->undo_to(S, mark2);
+            rollback(S, cp);
             continue;
         }
         if (dfs_dual_node(S, cfg, depth + 1)) {
             return true;
         }
-        S.trail->undo_to(S, mark2);
+        rollback(S, cp);
+        if (S.aborted) return false;
+    }
+    // Every py candidate failed: the state is dead, and the dfs_dual_node
+    // that follows on it is cut short by the table.
+    if (limit == ny) tt_store(S);
+    return false;
+}
+
+int dfs_count(SolverState& S, const SolverConfig& cfg, int limit) {
+    int count = 0;
+    if (limit <= 0) return 0;
+    dfs_count_node(S, cfg, 0, limit, count);
+    return count;
+}
+
+// Returns true once `count` reached `limit` (search stops); false means keep
+// going, and the caller undoes this subtree.
+static bool dfs_count_node(SolverState& S, const SolverConfig& cfg, int depth, int limit, int& count) {
+    ++S.nodes;
+    if (S.is_solved()) return ++count >= limit;
+    if (should_abort(S)) return false;
+    // Dead states found by solves still prune; counting stores nothing.
+    if (tt_dead(S)) return false;
+
+    int c = select_mrv_cell(S);
+    if (c < 0) return ++count >= limit;
+
+    uint16_t mask = S.cell_mask[c];
+    int cand[9];
+    int n = fill_candidates(mask, cand);
+    compute_scarcity(S);
+    sort_candidates_desc(cand, n, [&](int d){ return score_digit(S, c, d, cfg.scoring); });
+
+    Checkpoint cp = checkpoint(S, cfg, depth);
+    for (int i = 0; i < n; ++i) {
+        int d = cand[i];
+        if (place_digit(S, c, d) && propagate(S)) {
+            if (dfs_count_node(S, cfg, depth + 1, limit, count)) return true;
+        }
+        rollback(S, cp);
+        if (S.aborted) return false;
     }
     return false;
 }
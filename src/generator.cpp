@@ -0,0 +1,126 @@
+#include "generator.hpp"
+#include "solver.hpp"
+#include "output_buffer.hpp"
+#include "timing.hpp"
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+constexpr size_t kLineWidth = 82; // 81 cells + '\n'
+
+// Distinct nonzero stream per worker (splitmix64 of seed and worker id).
+uint64_t worker_seed(uint64_t seed, int id){
+    uint64_t z = seed + 0x9E3779B97F4A7C15ull * (uint64_t)(id + 1);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    z ^= z >> 31;
+    return z ? z : 1;
+}
+
+constexpr const char* kGradeNames[] = {"singles", "claiming", "pairs", "triples", "xwing", "search"};
+
+// Grader for g: propagation with the stages of g, giving up soon after the
+// first branch (see within_grade).
+SolverConfig grade_config(Grade g){
+    SolverConfig c;
+    c.limits.max_nodes = 1;
+    auto& inf = c.inference;
+    inf.claiming = g >= Grade::Claiming;
+    inf.naked_pairs = inf.hidden_pairs = g >= Grade::Pairs;
+    inf.naked_triples = inf.hidden_triples = g >= Grade::Triples;
+    inf.xwing = g >= Grade::XWing;
+    return c;
+}
+
+// True if the grader's rules alone solve grid: the root node (nodes() == 1)
+// is solved, so nothing was guessed and the solution is unique.
+bool within_grade(SudokuSolver& grader, const std::string& grid){
+    return grader.solve(grid) && grader.nodes() == 1;
+}
+
+// Dig a minimal puzzle out of `grid` (81 chars '1'..'9'): try every cell once
+// in random order and keep it empty if the puzzle stays unique and, with a
+// grader, within its grade.
+void dig(SudokuSolver& solver, SudokuSolver* grader, std::string& grid, uint64_t& rng){
+    int order[81];
+    for(int i = 0; i < 81; ++i) order[i] = i;
+    for(int i = 80; i > 0; --i) std::swap(order[i], order[next_random(rng) % (uint64_t)(i + 1)]);
+    for(int i : order){
+        char keep = grid[i];
+        grid[i] = '.';
+        bool ok = grader ? within_grade(*grader, grid) : solver.count_solutions(grid, 2) == 1;
+        if(!ok) grid[i] = keep;
+    }
+}
+} // namespace
+
+const char* grade_name(Grade g){ return kGradeNames[(int)g]; }
+
+bool parse_grade(std::string_view name, Grade& out){
+    for(int g = 0; g <= (int)Grade::Search; ++g){
+        if(name == kGradeNames[g]){ out = (Grade)g; return true; }
+    }
+    return false;
+}
+
+GeneratorResult generate_puzzles(const GeneratorOptions& opt, const SolverConfig& cfg){
+    int threads = opt.threads;
+    if(threads <= 0) threads = (int)std::max(1u, std::thread::hardware_concurrency());
+    threads = (int)std::max<size_t>(1, std::min<size_t>((size_t)threads, std::max<size_t>(1, opt.count)));
+
+    std::atomic<size_t> claimed{0};
+    std::atomic<size_t> attempts{0};
+    std::mutex out_mu;
+    OutputBuffer out(opt.fd);
+
+    auto worker = [&](int id){
+        SudokuSolver solver(cfg);
+        std::unique_ptr<SudokuSolver> cap, floor;
+        if(opt.max_grade < Grade::Search) cap = std::make_unique<SudokuSolver>(grade_config(opt.max_grade));
+        if(opt.min_grade > Grade::Singles)
+            floor = std::make_unique<SudokuSolver>(grade_config((Grade)((int)opt.min_grade - 1)));
+        uint64_t rng = worker_seed(opt.seed, id);
+        std::string grid(81, '.');
+        // Batched under out_mu; sized so appending never flushes on its own.
+        std::vector<char> local;
+        local.reserve(64 * kLineWidth);
+        auto publish = [&]{
+            std::lock_guard<std::mutex> lk(out_mu);
+            std::copy(local.begin(), local.end(), out.reserve(local.size()));
+            out.commit(local.size());
+            out.flush();
+            local.clear();
+        };
+
+        while(claimed.load(std::memory_order_relaxed) < opt.count){
+            if(!solver.fill_random(next_random(rng) | 1)) continue;
+            solver.solution_into(grid.data());
+            dig(solver, cap.get(), grid, rng);
+            size_t tried = attempts.fetch_add(1, std::memory_order_relaxed) + 1;
+            if(opt.max_attempts && tried > opt.max_attempts) break;
+
+            if(floor && within_grade(*floor, grid)) continue; // easier than min_grade
+            if(claimed.fetch_add(1, std::memory_order_relaxed) >= opt.count) break;
+            local.insert(local.end(), grid.begin(), grid.end());
+            local.push_back('\n');
+            if(local.size() + kLineWidth > local.capacity()) publish();
+        }
+        if(!local.empty()) publish();
+    };
+
+    const uint64_t wall_start = timing::mono_ns();
+    std::vector<std::thread> pool;
+    pool.reserve(threads);
+    for(int t = 0; t < threads; ++t) pool.emplace_back(worker, t);
+    for(auto& th : pool) th.join();
+
+    GeneratorResult res;
+    res.generated = std::min(claimed.load(), opt.count);
+    res.attempts = opt.max_attempts ? std::min(attempts.load(), opt.max_attempts) : attempts.load();
+    res.wall_ms = timing::ns_to_ms(timing::mono_ns() - wall_start);
+    return res;
+}
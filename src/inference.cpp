@@ -0,0 +1,216 @@
+#include "inference.hpp"
+#include "state.hpp"
+#include "propagation.hpp"
+#include "geometry.hpp"
+#include "timing.hpp"
+
+using geom::Bits81;
+using geom::band;
+using geom::bor;
+using geom::bnot;
+using geom::any;
+using geom::ctz;
+using geom::popcnt;
+
+namespace {
+inline int pop_lowest(Bits81& m){
+    int c = ctz(m);
+    if(c < 64) m.lo &= m.lo - 1; else m.hi &= m.hi - 1;
+    return c;
+}
+
+// Remove digit d from every cell of m that still allows it.
+bool clear_digit(SolverState& S, Bits81 m, int d, uint64_t& elims){
+    m = band(m, S.B[d]);
+    while(any(m)){
+        if(!eliminate_digit(S, pop_lowest(m), d)) return false;
+        ++elims;
+    }
+    return true;
+}
+
+// Remove the digits of `digits` (9-bit mask) from every cell of m.
+bool clear_digits(SolverState& S, Bits81 m, unsigned digits, uint64_t& elims){
+    while(digits){
+        int d = __builtin_ctz(digits);
+        digits &= digits - 1;
+        if(!clear_digit(S, m, d, elims)) return false;
+    }
+    return true;
+}
+
+// Row or column whose candidates for d all lie in one box: d is locked to
+// that line inside the box, so clear it from the box's other cells. (The
+// box-to-line direction is process_lock_event.)
+bool claiming(SolverState& S, uint64_t& elims){
+    for(int d = 0; d < 9; ++d){
+        for(int u = 0; u < 18; ++u){
+            if(S.unit_digit_count[u][d] < 2) continue; // placed, single or empty
+            Bits81 m = band(S.B[d], geom::UNIT_MASK[u]);
+            int b = geom::BOX[ctz(m)];
+            if(any(band(m, bnot(geom::BOX_MASK[b])))) continue;
+            if(!clear_digit(S, band(geom::BOX_MASK[b], bnot(geom::UNIT_MASK[u])), d, elims)) return false;
+        }
+    }
+    return true;
+}
+
+// k (2 or 3) open cells of a unit whose candidates together are k digits:
+// those digits can go nowhere else in the unit.
+bool naked_subsets(SolverState& S, int k, uint64_t& elims){
+    for(int u = 0; u < 27; ++u){
+        const Bits81 unit_open = band(S.open, geom::UNIT_MASK[u]);
+        if(popcnt(unit_open) <= k) continue;
+        Bits81 small = band(S.mrv_bucket[2], unit_open);
+        if(k == 3) small = bor(small, band(S.mrv_bucket[3], unit_open));
+        int cells[9], n = 0;
+        while(any(small)) cells[n++] = pop_lowest(small);
+        if(n < k) continue;
+
+        for(int i = 0; i < n; ++i){
+            for(int j = i + 1; j < n; ++j){
+                if(k == 2){
+                    unsigned m = S.cell_mask[cells[i]];
+                    if(m != S.cell_mask[cells[j]] || __builtin_popcount(m) != 2) continue;
+                    Bits81 rest = unit_open;
+                    geom::clr_bit(rest, cells[i]);
+                    geom::clr_bit(rest, cells[j]);
+                    if(!clear_digits(S, rest, m, elims)) return false;
+                    continue;
+                }
+                for(int l = j + 1; l < n; ++l){
+                    unsigned m = S.cell_mask[cells[i]] | S.cell_mask[cells[j]] | S.cell_mask[cells[l]];
+                    if(__builtin_popcount(m) != 3) continue;
+                    Bits81 rest = unit_open;
+                    geom::clr_bit(rest, cells[i]);
+                    geom::clr_bit(rest, cells[j]);
+                    geom::clr_bit(rest, cells[l]);
+                    if(!clear_digits(S, rest, m, elims)) return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+// k (2 or 3) digits of a unit confined to the same k cells: those cells can
+// hold no other digit.
+bool hidden_subsets(SolverState& S, int k, uint64_t& elims){
+    for(int u = 0; u < 27; ++u){
+        int digits[9], n = 0;
+        Bits81 pos[9];
+        for(int d = 0; d < 9; ++d){
+            int cnt = S.unit_digit_count[u][d];
+            if(cnt < 2 || cnt > k) continue; // count >= 2 => not placed in this unit
+            digits[n] = d;
+            pos[n++] = band(S.B[d], geom::UNIT_MASK[u]);
+        }
+        if(n < k) continue;
+
+        for(int i = 0; i < n; ++i){
+            for(int j = i + 1; j < n; ++j){
+                if(k == 2){
+                    if(pos[i].lo != pos[j].lo || pos[i].hi != pos[j].hi) continue;
+                    unsigned others = 0x1FFu & ~((1u << digits[i]) | (1u << digits[j]));
+                    if(!clear_digits(S, pos[i], others, elims)) return false;
+                    continue;
+                }
+                for(int l = j + 1; l < n; ++l){
+                    Bits81 cells = bor(bor(pos[i], pos[j]), pos[l]);
+                    if(popcnt(cells) != 3) continue;
+                    unsigned others = 0x1FFu & ~((1u << digits[i]) | (1u << digits[j]) | (1u << digits[l]));
+                    if(!clear_digits(S, cells, others, elims)) return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+// Two rows (columns) holding d in exactly the same two columns (rows): d is
+// confined to those four cells within the two cover lines.
+bool xwing(SolverState& S, uint64_t& elims){
+    for(int d = 0; d < 9; ++d){
+        for(int base = 0; base < 18; base += 9){ // rows then columns
+            const int cover = 9 - base;           // unit offset of the crossing lines
+            int lines[9], a[9], b[9], n = 0;
+            for(int i = 0; i < 9; ++i){
+                if(S.unit_digit_count[base + i][d] != 2) continue;
+                Bits81 m = band(S.B[d], geom::UNIT_MASK[base + i]);
+                int c0 = pop_lowest(m), c1 = ctz(m);
+                lines[n] = base + i;
+                a[n] = base ? geom::ROW[c0] : geom::COL[c0];
+                b[n++] = base ? geom::ROW[c1] : geom::COL[c1];
+            }
+            for(int i = 0; i < n; ++i){
+                for(int j = i + 1; j < n; ++j){
+                    if(a[i] != a[j] || b[i] != b[j]) continue;
+                    Bits81 m = bor(geom::UNIT_MASK[cover + a[i]], geom::UNIT_MASK[cover + b[i]]);
+                    m = band(m, bnot(bor(geom::UNIT_MASK[lines[i]], geom::UNIT_MASK[lines[j]])));
+                    if(!clear_digit(S, m, d, elims)) return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+bool run_stage(SolverState& S, InferenceStage s, uint64_t& elims){
+    switch(s){
+    case InferenceStage::Claiming:      return claiming(S, elims);
+    case InferenceStage::NakedPairs:    return naked_subsets(S, 2, elims);
+    case InferenceStage::HiddenPairs:   return hidden_subsets(S, 2, elims);
+    case InferenceStage::NakedTriples:  return naked_subsets(S, 3, elims);
+    case InferenceStage::HiddenTriples: return hidden_subsets(S, 3, elims);
+    case InferenceStage::XWing:         return xwing(S, elims);
+    default: return true;
+    }
+}
+} // namespace
+
+const char* inference_stage_name(InferenceStage s){
+    switch(s){
+    case InferenceStage::Claiming:      return "claiming";
+    case InferenceStage::NakedPairs:    return "naked-pairs";
+    case InferenceStage::HiddenPairs:   return "hidden-pairs";
+    case InferenceStage::NakedTriples:  return "naked-triples";
+    case InferenceStage::HiddenTriples: return "hidden-triples";
+    case InferenceStage::XWing:         return "xwing";
+    default: return "?";
+    }
+}
+
+bool inference_stage_enabled(const InferenceConfig& c, InferenceStage s){
+    switch(s){
+    case InferenceStage::Claiming:      return c.claiming;
+    case InferenceStage::NakedPairs:    return c.naked_pairs;
+    case InferenceStage::HiddenPairs:   return c.hidden_pairs;
+    case InferenceStage::NakedTriples:  return c.naked_triples;
+    case InferenceStage::HiddenTriples: return c.hidden_triples;
+    case InferenceStage::XWing:         return c.xwing;
+    default: return false;
+    }
+}
+
+int run_inference(SolverState& S){
+    if(!S.inference) return 0;
+    for(int i = 0; i < kInferenceStages; ++i){
+        const auto stage = (InferenceStage)i;
+        if(!inference_stage_enabled(*S.inference, stage)) continue;
+        uint64_t elims = 0;
+        bool ok;
+        if constexpr(cfg::kStats){
+            uint64_t t0 = timing::ticks();
+            ok = run_stage(S, stage, elims);
+            auto& st = S.inference_stats;
+            st.ticks[i] += timing::ticks() - t0;
+            ++st.runs[i];
+            st.eliminations[i] += elims;
+        } else {
+            ok = run_stage(S, stage, elims);
+        }
+        if(!ok) return -1;
+        if(elims) return 1;
+    }
+    return 0;
+}
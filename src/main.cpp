@@ -1,34 +1,27 @@
+#include <algorithm>
 #include <iostream>
-#include <fstream>
 #include <string>
-#include <cctype>
-#include <chrono>
-#include <sys/resource.h>
+#include <string_view>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <vector>
 #include "solver.hpp"
+#include "batch.hpp"
+#include "puzzle_reader.hpp"
+#include "output_buffer.hpp"
+#include "board_simd.hpp"
+#include "timing.hpp"
+#include "generator.hpp"
+#include "stream.hpp"
+#include "server.hpp"
+#include "packed.hpp"
+#include "config_file.hpp"
+#include "tuner.hpp"
+#include <fcntl.h>
+#include <unistd.h>
 
 namespace {
-using SteadyClock = std::chrono::steady_clock;
-
-double cpu_time_seconds(){
-    rusage ru{};
-    getrusage(RUSAGE_SELF, &ru);
-    double user = ru.ru_utime.tv_sec + ru.ru_utime.tv_usec * 1e-6;
-    double sys  = ru.ru_stime.tv_sec + ru.ru_stime.tv_usec * 1e-6;
-    return user + sys;
-}
-
-inline double wall_ms(SteadyClock::time_point start, SteadyClock::time_point end){
-    return std::chrono::duration<double, std::milli>(end - start).count();
-}
-
-std::string trim(const std::string& in){
-    size_t start = 0;
-    while(start < in.size() && std::isspace(static_cast<unsigned char>(in[start]))) ++start;
-    size_t end = in.size();
-    while(end > start && std::isspace(static_cast<unsigned char>(in[end-1]))) --end;
-    return in.substr(start, end - start);
-}
-
 void print_timings(const SolverTimings& solver_times,
                    double solve_wall_ms,
                    double solve_cpu_ms,
@@ -41,46 +34,529 @@ void print_timings(const SolverTimings& solver_times,
               << "output(w=" << output_wall_ms << "ms cpu=" << output_cpu_ms << "ms)\n";
 }
 
-bool solve_and_print(SudokuSolver& solver, const std::string& puzzle, bool timings_enabled){
-    SolverTimings solver_times;
-    SolverTimings* timings_ptr = timings_enabled ? &solver_times : nullptr;
+enum class StatsFormat : uint8_t { None, Json, Csv };
+
+// SolverStats as one JSON object or CSV row; `key` names the leading column
+// (the puzzle's line number, or the puzzle count for an aggregate).
+void print_stats_header(std::ostream& os, StatsFormat fmt, const char* key){
+    if(fmt != StatsFormat::Csv) return;
+    os << key << ",solved,nodes,max_depth,backtracks,place_calls,elim_calls,"
+                 "lock_events,lock_productive,trail_peak,py_fires\n";
+}
 
-    auto solve_wall_start = SteadyClock::now();
-    double solve_cpu_start = cpu_time_seconds();
-    bool ok = solver.solve(puzzle, timings_ptr);
-    auto solve_wall_end = SteadyClock::now();
-    double solve_cpu_end = cpu_time_seconds();
+void print_stats(std::ostream& os, StatsFormat fmt, const char* key, uint64_t key_value,
+                 uint64_t solved, const SolverStats& st){
+    static const char* const names[] = {
+        "nodes", "max_depth", "backtracks", "place_calls", "elim_calls",
+        "lock_events", "lock_productive", "trail_peak", "py_fires"};
+    const uint64_t values[] = {
+        st.nodes, st.max_depth, st.backtracks, st.place_calls, st.elim_calls,
+        st.lock_events, st.lock_productive, st.trail_peak, st.py_fires};
+    if(fmt == StatsFormat::Csv){
+        os << key_value << ',' << solved;
+        for(uint64_t v : values) os << ',' << v;
+    }else{
+        os << "{\"" << key << "\":" << key_value << ",\"solved\":" << solved;
+        for(size_t i = 0; i < std::size(values); ++i) os << ",\"" << names[i] << "\":" << values[i];
+        os << '}';
+    }
+    os << '\n';
+}
 
-    auto output_wall_start = SteadyClock::now();
-    double output_cpu_start = cpu_time_seconds();
+void append_result(OutputBuffer& out, const SudokuSolver& solver, bool ok){
     if(ok){
-        std::cout << solver.solution_string() << "\n";
+        char* p = out.reserve(82);
+        solver.solution_into(p);
+        p[81] = '\n';
+        out.commit(82);
     }else{
-        std::cout << "UNSOLVED/CONTRADICTION\n";
+        out.append(solver.result() == SolveResult::Timeout ? kTimeoutText : kUnsolvedText);
+        out.put('\n');
     }
-    auto output_wall_end = SteadyClock::now();
-    double output_cpu_end = cpu_time_seconds();
+}
+
+// Text or packed, whichever the puzzle carries.
+bool solve_one(SudokuSolver& solver, const PuzzleLine& puzzle, SolverTimings* timings = nullptr){
+    return puzzle.packed ? solver.solve_packed(puzzle.packed, timings) : solver.solve(puzzle.text, timings);
+}
 
-    if(timings_enabled){
+bool solve_and_print(SudokuSolver& solver, const PuzzleLine& puzzle, bool timings_enabled,
+                     StatsFormat stats, OutputBuffer& out){
+    bool ok;
+    if(!timings_enabled){
+        ok = solve_one(solver, puzzle);
+        append_result(out, solver, ok);
+    }else{
+        // Clocks are read only here, so untimed runs pay for none of them.
+        SolverTimings solver_times;
+        timing::ns_per_tick(); // calibrate outside the measured interval
+        const uint64_t solve_t0 = timing::ticks();
+        const uint64_t solve_cpu0 = timing::thread_cpu_ns();
+        ok = solve_one(solver, puzzle, &solver_times);
+        const uint64_t solve_t1 = timing::ticks();
+        const uint64_t solve_cpu1 = timing::thread_cpu_ns();
+        // The output phase includes the write(2): with --timings every
+        // answer is flushed on its own (a failure stays in out.ok()).
+        append_result(out, solver, ok);
+        out.flush();
+        const uint64_t output_t1 = timing::ticks();
+        const uint64_t output_cpu1 = timing::thread_cpu_ns();
         print_timings(solver_times,
-                      wall_ms(solve_wall_start, solve_wall_end),
-                      (solve_cpu_end - solve_cpu_start) * 1000.0,
-                      wall_ms(output_wall_start, output_wall_end),
-                      (output_cpu_end - output_cpu_start) * 1000.0);
+                      timing::ticks_to_ms(solve_t1 - solve_t0),
+                      timing::ns_to_ms(solve_cpu1 - solve_cpu0),
+                      timing::ticks_to_ms(output_t1 - solve_t1),
+                      timing::ns_to_ms(output_cpu1 - solve_cpu1));
     }
-
+    if(stats != StatsFormat::None) print_stats(std::cerr, stats, "line", puzzle.line, ok, solver.stats());
     return ok;
 }
+
+const char* boards_name(BoardBackend b){
+    return b == BoardBackend::Simd ? simd::backend_name() : "scalar";
+}
+
+const char* engine_name(Engine e){
+    return e == Engine::Band ? "band" : "cell";
+}
+
+const char* restore_name(RestoreMode r){
+    switch(r){
+    case RestoreMode::Snapshot: return "snapshot";
+    case RestoreMode::Hybrid: return "hybrid";
+    default: return "trail";
+    }
+}
+
+// --max-nodes N, --max-trail N or --timeout-ms MS (fractions allowed).
+bool parse_limit(std::string_view flag, const char* value, SolveLimits& limits){
+    char* end = nullptr;
+    double v = std::strtod(value, &end);
+    if(end == value || *end != '\0' || !(v > 0.0)) return false;
+    if(flag == "--max-nodes") limits.max_nodes = (uint64_t)v;
+    else if(flag == "--max-trail") limits.max_trail = (size_t)v;
+    else limits.max_us = std::max<uint64_t>(1, (uint64_t)(v * 1000.0));
+    return true;
+}
+
+// "all" or a comma-separated list of stage names (inference_stage_name).
+bool parse_inference(std::string_view list, InferenceConfig& out){
+    out = InferenceConfig{};
+    while(!list.empty()){
+        size_t comma = list.find(',');
+        std::string_view name = list.substr(0, comma);
+        list = comma == std::string_view::npos ? std::string_view{} : list.substr(comma + 1);
+        bool found = false;
+        for(int i = 0; i < kInferenceStages; ++i){
+            auto stage = (InferenceStage)i;
+            if(name != "all" && name != inference_stage_name(stage)) continue;
+            switch(stage){
+            case InferenceStage::Claiming:      out.claiming = true; break;
+            case InferenceStage::NakedPairs:    out.naked_pairs = true; break;
+            case InferenceStage::HiddenPairs:   out.hidden_pairs = true; break;
+            case InferenceStage::NakedTriples:  out.naked_triples = true; break;
+            case InferenceStage::HiddenTriples: out.hidden_triples = true; break;
+            case InferenceStage::XWing:         out.xwing = true; break;
+            default: break;
+            }
+            found = true;
+        }
+        if(!found) return false;
+    }
+    return true;
+}
+
+void print_inference_stats(const InferenceStats& st, const InferenceConfig& cfg){
+    for(int i = 0; i < kInferenceStages; ++i){
+        auto stage = (InferenceStage)i;
+        if(!inference_stage_enabled(cfg, stage)) continue;
+        std::cout << "  stage=" << inference_stage_name(stage)
+                  << " runs=" << st.runs[i]
+                  << " eliminations=" << st.eliminations[i]
+                  << " ms=" << timing::ticks_to_ms(st.ticks[i]) << "\n";
+    }
+}
+
+// Portfolio races and how often each strategy won (only with --portfolio).
+void print_portfolio_stats(const PortfolioStats& st, const SolverConfig& cfg){
+    if(!cfg.portfolio) return;
+    std::cout << "portfolio races=" << st.races;
+    for(int i = 0; i < kPortfolioStrategies; ++i)
+        std::cout << ' ' << portfolio_strategy_name(i) << '=' << st.wins[i];
+    std::cout << "\n";
+}
+
+// Per-puzzle latency: tail percentiles, then the non-empty log2 buckets.
+void print_latency(timing::LatencyHistogram& h){
+    if(!h.count()) return;
+    auto us = [](uint64_t ns){ return (double)ns / 1000.0; };
+    std::cout << "latency_us p50=" << us(h.percentile(50))
+              << " p90=" << us(h.percentile(90))
+              << " p99=" << us(h.percentile(99))
+              << " p99.9=" << us(h.percentile(99.9))
+              << " max=" << us(h.max()) << "\n";
+    const auto& buckets = h.buckets();
+    for(size_t k = 0; k < buckets.size(); ++k){
+        if(!buckets[k]) continue;
+        std::cout << "  latency_us=[" << us(k ? 1ull << k : 0) << "," << us(2ull << k)
+                  << ") puzzles=" << buckets[k] << "\n";
+    }
+}
+
+// Result cache line of the benchmark output (only with --cache).
+void print_cache_stats(const CacheStats& c, const SolverConfig& cfg){
+    if(!cfg.cache_entries) return;
+    const uint64_t lookups = c.hits + c.misses;
+    std::cout << "cache entries=" << cfg.cache_entries
+              << " hits=" << c.hits
+              << " misses=" << c.misses
+              << " evictions=" << c.evictions
+              << " hit_rate=" << (lookups ? (double)c.hits / (double)lookups : 0.0) << "\n";
+}
+
+// Dead-state table line of the benchmark output (only with --tt-mb).
+void print_tt_stats(const TTStats& t, const SolverConfig& cfg){
+    if(!cfg.tt_mb) return;
+    std::cout << "tt mb=" << cfg.tt_mb
+              << " probes=" << t.probes
+              << " hits=" << t.hits
+              << " stores=" << t.stores
+              << " hit_rate=" << (t.probes ? (double)t.hits / (double)t.probes : 0.0) << "\n";
+}
+
+void print_batch_benchmark(BatchResult& res, const SolverConfig& cfg){
+    double secs = res.wall_ms / 1000.0;
+    std::cout << "benchmark puzzles=" << res.puzzles
+              << " solved=" << res.solved;
+    if(res.count_limit > 0) std::cout << " unique=" << res.unique;
+    if(cfg.limits.any()) std::cout << " timeouts=" << res.timeouts;
+    std::cout << " threads=" << res.per_thread.size()
+              << " engine=" << engine_name(cfg.engine)
+              << " boards=" << boards_name(cfg.boards)
+              << " restore=" << restore_name(cfg.restore)
+              << " nodes=" << res.nodes
+              << " wall_ms=" << res.wall_ms
+              << " cpu_ms=" << res.cpu_ms
+              << " puzzles_per_sec=" << (secs > 0.0 ? res.puzzles / secs : 0.0) << "\n";
+    for(size_t t = 0; t < res.per_thread.size(); ++t){
+        const auto& st = res.per_thread[t];
+        double busy = st.busy_ms / 1000.0;
+        std::cout << "  thread=" << t
+                  << " puzzles=" << st.puzzles
+                  << " solved=" << st.solved
+                  << " steals=" << st.steals
+                  << " nodes=" << st.nodes
+                  << " busy_ms=" << st.busy_ms
+                  << " puzzles_per_sec=" << (busy > 0.0 ? st.puzzles / busy : 0.0) << "\n";
+    }
+    print_latency(res.latency);
+    print_cache_stats(res.cache, cfg);
+    print_tt_stats(res.tt, cfg);
+    print_portfolio_stats(res.portfolio, cfg);
+    print_inference_stats(res.inference, cfg.inference);
+}
+
+void print_stats_aggregate(StatsFormat fmt, size_t puzzles, size_t solved, const SolverStats& st){
+    if(fmt == StatsFormat::None) return;
+    print_stats_header(std::cout, fmt, "puzzles");
+    print_stats(std::cout, fmt, "puzzles", puzzles, solved, st);
+}
+// cppsolver generate [--count N] [--threads N] [--seed S] [--min-grade G]
+//                   [--max-grade G] [--max-attempts N]
+int run_generate(int argc, char** argv){
+    GeneratorOptions opt;
+    for(int i = 1; i < argc; ++i){
+        std::string arg = argv[i];
+        if(i + 1 >= argc){
+            std::cerr << "generate: " << arg << " requires a value\n";
+            return 1;
+        }
+        const char* v = argv[++i];
+        if(arg == "--count") opt.count = std::strtoull(v, nullptr, 10);
+        else if(arg == "--threads") opt.threads = std::atoi(v);
+        else if(arg == "--seed") opt.seed = std::strtoull(v, nullptr, 10);
+        else if(arg == "--min-grade" || arg == "--max-grade"){
+            if(!parse_grade(v, arg == "--min-grade" ? opt.min_grade : opt.max_grade)){
+                std::cerr << "generate: unknown grade " << v
+                          << " (singles|claiming|pairs|triples|xwing|search)\n";
+                return 1;
+            }
+        }
+        else if(arg == "--max-attempts") opt.max_attempts = std::strtoull(v, nullptr, 10);
+        else{
+            std::cerr << "generate: unknown option " << arg << "\n";
+            return 1;
+        }
+    }
+    if(opt.min_grade > opt.max_grade){
+        std::cerr << "generate: --min-grade exceeds --max-grade\n";
+        return 1;
+    }
+    GeneratorResult res = generate_puzzles(opt, SolverConfig{});
+    double secs = res.wall_ms / 1000.0;
+    std::cerr << "generate puzzles=" << res.generated
+              << " attempts=" << res.attempts
+              << " wall_ms=" << res.wall_ms
+              << " puzzles_per_sec=" << (secs > 0.0 ? res.generated / secs : 0.0) << "\n";
+    return res.generated == opt.count ? 0 : 1;
+}
+// cppsolver serve [--unix PATH] [--tcp PORT] [--threads N] [--count N]
+//                 [--max-request N] [--max-line N] [--max-inflight N]
+//                 [--max-output N] [--cache N] [--max-nodes N] [--max-trail N]
+//                 [--timeout-ms MS]
+int run_serve(int argc, char** argv){
+    ServeOptions opt;
+    SolverConfig cfg;
+    for(int i = 1; i < argc; ++i){
+        std::string arg = argv[i];
+        if(i + 1 >= argc){
+            std::cerr << "serve: " << arg << " requires a value\n";
+            return 1;
+        }
+        const char* v = argv[++i];
+        if(arg == "--unix") opt.unix_path = v;
+        else if(arg == "--tcp") opt.tcp_port = std::atoi(v);
+        else if(arg == "--threads") opt.threads = std::atoi(v);
+        else if(arg == "--count") opt.count_limit = std::atoi(v);
+        else if(arg == "--max-request") opt.max_request = std::strtoull(v, nullptr, 10);
+        else if(arg == "--max-line") opt.max_line = std::strtoull(v, nullptr, 10);
+        else if(arg == "--max-inflight") opt.max_inflight = std::strtoull(v, nullptr, 10);
+        else if(arg == "--max-output") opt.max_output = std::strtoull(v, nullptr, 10);
+        else if(arg == "--cache") cfg.cache_entries = std::strtoull(v, nullptr, 10);
+        else if(arg == "--max-nodes" || arg == "--max-trail" || arg == "--timeout-ms"){
+            if(!parse_limit(arg, v, cfg.limits)){
+                std::cerr << "serve: " << arg << " requires a positive number\n";
+                return 1;
+            }
+        }
+        else{
+            std::cerr << "serve: unknown option " << arg << "\n";
+            return 1;
+        }
+    }
+    if(opt.unix_path.empty() && opt.tcp_port <= 0){
+        std::cerr << "serve: needs --unix PATH and/or --tcp PORT\n";
+        return 1;
+    }
+    if(opt.max_line == 0 || opt.max_inflight == 0 || opt.max_output == 0){
+        std::cerr << "serve: --max-line, --max-inflight and --max-output must be positive\n";
+        return 1;
+    }
+    return run_server(cfg, opt);
+}
+// cppsolver convert IN OUT [--index]
+// Text to packed or packed to text, by the format of IN ("-" for OUT is
+// stdout). --index keeps the text line numbers in the packed file.
+int run_convert(int argc, char** argv){
+    std::string in_path, out_path;
+    bool index = false;
+    for(int i = 1; i < argc; ++i){
+        std::string arg = argv[i];
+        if(arg == "--index") index = true;
+        else if(in_path.empty()) in_path = arg;
+        else if(out_path.empty()) out_path = arg;
+        else{
+            std::cerr << "convert: unexpected argument " << arg << "\n";
+            return 1;
+        }
+    }
+    if(out_path.empty()){
+        std::cerr << "convert: usage: cppsolver convert IN OUT [--index]\n";
+        return 1;
+    }
+    MappedFile in;
+    if(!in.open(in_path)){
+        std::cerr << "convert: failed to open " << in_path << ": " << std::strerror(errno) << "\n";
+        return 1;
+    }
+    PuzzleSource reader;
+    std::string err;
+    if(!reader.open(in.view(), err)){
+        std::cerr << "convert: " << in_path << ": " << err << "\n";
+        return 1;
+    }
+    int fd = 1;
+    if(out_path != "-"){
+        fd = ::open(out_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if(fd < 0){
+            std::cerr << "convert: failed to create " << out_path << ": " << std::strerror(errno) << "\n";
+            return 1;
+        }
+    }
+
+    PuzzleLine pl;
+    uint64_t records = 0;
+    bool ok;
+    {
+        OutputBuffer out(fd);
+        if(reader.is_packed()){
+            while(reader.next(pl)){
+                char* p = out.reserve(82);
+                packed::unpack_grid(pl.packed, p);
+                p[81] = '\n';
+                out.commit(82);
+                ++records;
+            }
+        }else{
+            // The header needs the count up front: one cheap pass to count.
+            PuzzleSource counter = reader;
+            while(counter.next(pl)) ++records;
+            packed::write_header(reinterpret_cast<uint8_t*>(out.reserve(packed::kHeaderBytes)),
+                                 records, index ? packed::kHasIndex : 0);
+            out.commit(packed::kHeaderBytes);
+            std::vector<uint64_t> lines;
+            if(index) lines.reserve(records);
+            while(reader.next(pl)){
+                packed::pack_grid(pl.text, reinterpret_cast<uint8_t*>(out.reserve(packed::kRecordBytes)));
+                out.commit(packed::kRecordBytes);
+                if(index) lines.push_back(pl.line);
+            }
+            for(uint64_t line : lines){
+                uint8_t* p = reinterpret_cast<uint8_t*>(out.reserve(8));
+                for(int b = 0; b < 8; ++b) p[b] = (uint8_t)(line >> (8 * b));
+                out.commit(8);
+            }
+        }
+        ok = out.flush();
+    }
+    if(fd != 1 && ::close(fd) != 0) ok = false;
+    if(!ok){
+        std::cerr << "convert: write to " << out_path << " failed: " << std::strerror(errno) << "\n";
+        return 1;
+    }
+    std::cerr << "convert records=" << records << " to=" << (reader.is_packed() ? "text" : "packed") << "\n";
+    return 0;
+}
+// cppsolver tune --file PUZZLES [--method random|grid|halving] [--trials N]
+//                [--threads N] [--seed S] [--objective nodes|time]
+//                [--out PATH] [--config PATH] [--max-nodes N] [--max-trail N]
+//                [--timeout-ms MS]
+// Searches DualConfig and the scoring weights on PUZZLES, starting from the
+// defaults (or --config), and writes the best to PATH (default tuned.cfg).
+int run_tune(int argc, char** argv){
+    TuneOptions opt;
+    opt.log = &std::cerr;
+    SolverConfig cfg;
+    std::string file_path, out_path = "tuned.cfg";
+    for(int i = 1; i < argc; ++i){
+        std::string arg = argv[i];
+        if(i + 1 >= argc){
+            std::cerr << "tune: " << arg << " requires a value\n";
+            return 1;
+        }
+        const char* v = argv[++i];
+        std::string_view sv = v;
+        if(arg == "--file") file_path = v;
+        else if(arg == "--out") out_path = v;
+        else if(arg == "--trials") opt.trials = std::strtoull(v, nullptr, 10);
+        else if(arg == "--threads") opt.threads = std::atoi(v);
+        else if(arg == "--seed") opt.seed = std::strtoull(v, nullptr, 10);
+        else if(arg == "--method"){
+            if(sv == "random") opt.method = TuneMethod::Random;
+            else if(sv == "grid") opt.method = TuneMethod::Grid;
+            else if(sv == "halving") opt.method = TuneMethod::Halving;
+            else{
+                std::cerr << "tune: --method expects random|grid|halving\n";
+                return 1;
+            }
+        }else if(arg == "--objective"){
+            if(sv == "nodes") opt.objective = TuneObjective::Nodes;
+            else if(sv == "time") opt.objective = TuneObjective::Time;
+            else{
+                std::cerr << "tune: --objective expects nodes|time\n";
+                return 1;
+            }
+        }else if(arg == "--config"){
+            std::string err;
+            if(!load_config_file(v, cfg, err)){
+                std::cerr << "tune: " << err << "\n";
+                return 1;
+            }
+        }else if(arg == "--max-nodes" || arg == "--max-trail" || arg == "--timeout-ms"){
+            if(!parse_limit(arg, v, cfg.limits)){
+                std::cerr << "tune: " << arg << " requires a positive number\n";
+                return 1;
+            }
+        }else{
+            std::cerr << "tune: unknown option " << arg << "\n";
+            return 1;
+        }
+    }
+    if(file_path.empty()){
+        std::cerr << "tune: needs --file PUZZLES\n";
+        return 1;
+    }
+    MappedFile in;
+    if(!in.open(file_path)){
+        std::cerr << "tune: failed to open " << file_path << ": " << std::strerror(errno) << "\n";
+        return 1;
+    }
+    PuzzleSource reader;
+    std::string err;
+    if(!reader.open(in.view(), err)){
+        std::cerr << "tune: " << file_path << ": " << err << "\n";
+        return 1;
+    }
+    std::vector<BatchPuzzle> puzzles;
+    PuzzleLine pl;
+    while(reader.next(pl)) puzzles.push_back(BatchPuzzle{pl.line, pl.text, pl.packed});
+    if(puzzles.empty()){
+        std::cerr << "tune: " << file_path << " has no puzzles\n";
+        return 1;
+    }
+
+    TuneResult res = tune(puzzles, cfg, opt);
+    static const char* const methods[] = {"random", "grid", "halving"};
+    std::string header = "# cppsolver tune method=" + std::string(methods[(int)opt.method])
+                       + " objective=" + (opt.objective == TuneObjective::Nodes ? "nodes" : "time")
+                       + " file=" + file_path + "\n"
+                       + "# puzzles=" + std::to_string(res.best_score.puzzles)
+                       + " nodes=" + std::to_string(res.best_score.nodes)
+                       + " baseline_nodes=" + std::to_string(res.baseline.nodes) + "\n";
+    if(!save_config_file(out_path, res.best, header, err)){
+        std::cerr << "tune: " << err << "\n";
+        return 1;
+    }
+    std::cerr << "tune candidates=" << res.evaluated
+              << " puzzles=" << res.best_score.puzzles
+              << " nodes=" << res.best_score.nodes << " (baseline " << res.baseline.nodes << ")"
+              << " cpu_ms=" << res.best_score.cpu_ms << " (baseline " << res.baseline.cpu_ms << ")"
+              << " timeouts=" << res.best_score.timeouts << " (baseline " << res.baseline.timeouts << ")"
+              << " wall_ms=" << res.wall_ms << " out=" << out_path << "\n";
+    return 0;
+}
 } // namespace
 
 int main(int argc, char** argv){
     std::ios::sync_with_stdio(false);
     std::cin.tie(nullptr);
 
+    if(argc > 1 && std::string_view(argv[1]) == "generate") return run_generate(argc - 1, argv + 1);
+    if(argc > 1 && std::string_view(argv[1]) == "serve") return run_serve(argc - 1, argv + 1);
+    if(argc > 1 && std::string_view(argv[1]) == "convert") return run_convert(argc - 1, argv + 1);
+    if(argc > 1 && std::string_view(argv[1]) == "tune") return run_tune(argc - 1, argv + 1);
+
     bool timings_enabled = false;
     bool dual_enabled = false;
+    BoardBackend boards = BoardBackend::Scalar;
+    Engine engine = Engine::Cell;
+    Branching branching = Branching::Mrv;
+    RestoreMode restore = RestoreMode::Trail;
+    int snapshot_depth = -1;
+    InferenceConfig inference;
+    StatsFormat stats = StatsFormat::None;
     bool benchmark_mode = false;
+    bool unordered = false;
+    bool stream_mode = false;
+    StreamOptions stream_opt;
+    int threads = -1; // -1 => classic single-threaded path
+    size_t cache_entries = 0;
+    size_t tt_mb = 0;
+    ParallelConfig parallel;
+    SolveLimits limits;
+    bool portfolio = false;
+    int count_limit = 0;
     std::string file_path;
+    std::string config_path;
     std::string puzzle_arg;
 
     for(int i=1; i<argc; ++i){
@@ -91,60 +567,265 @@ int main(int argc, char** argv){
                 return 1;
             }
             file_path = argv[++i];
+        }else if(arg == "--config"){
+            if(i+1 >= argc){
+                std::cerr << "--config requires a path\n";
+                return 1;
+            }
+            config_path = argv[++i];
         }else if(arg == "--timings"){
             timings_enabled = true;
         }else if(arg == "--benchmark"){
             benchmark_mode = true;
+        }else if(arg == "--parallel"){
+            if(i+1 >= argc){
+                std::cerr << "--parallel requires a thread count (0 = all cores)\n";
+                return 1;
+            }
+            parallel.threads = std::atoi(argv[++i]);
+        }else if(arg == "--parallel-budget"){
+            if(i+1 >= argc){
+                std::cerr << "--parallel-budget requires a node count\n";
+                return 1;
+            }
+            parallel.node_budget = std::strtoull(argv[++i], nullptr, 10);
+        }else if(arg == "--max-nodes" || arg == "--max-trail" || arg == "--timeout-ms"){
+            if(i+1 >= argc || !parse_limit(arg, argv[++i], limits)){
+                std::cerr << arg << " requires a positive number\n";
+                return 1;
+            }
+        }else if(arg == "--cache"){
+            if(i+1 >= argc){
+                std::cerr << "--cache requires an entry count\n";
+                return 1;
+            }
+            cache_entries = std::strtoull(argv[++i], nullptr, 10);
+        }else if(arg == "--tt-mb"){
+            if(i+1 >= argc){
+                std::cerr << "--tt-mb requires a size in MiB\n";
+                return 1;
+            }
+            tt_mb = std::strtoull(argv[++i], nullptr, 10);
+        }else if(arg == "--threads"){
+            if(i+1 >= argc){
+                std::cerr << "--threads requires a count (0 = all cores)\n";
+                return 1;
+            }
+            threads = std::atoi(argv[++i]);
+        }else if(arg == "--count"){
+            if(i+1 >= argc){
+                std::cerr << "--count requires a limit (e.g. 2 for a uniqueness check)\n";
+                return 1;
+            }
+            count_limit = std::atoi(argv[++i]);
+            if(count_limit < 1){
+                std::cerr << "--count limit must be >= 1\n";
+                return 1;
+            }
+        }else if(arg == "--stream"){
+            stream_mode = true;
+        }else if(arg == "--stream-batch" || arg == "--flush-ms" || arg == "--max-line"){
+            if(i+1 >= argc){
+                std::cerr << arg << " requires a number\n";
+                return 1;
+            }
+            int v = std::atoi(argv[++i]);
+            if(v < 0 || (v == 0 && arg == "--max-line")){
+                std::cerr << arg << (arg == "--max-line" ? " must be > 0\n" : " must be >= 0\n");
+                return 1;
+            }
+            if(arg == "--flush-ms") stream_opt.flush_ms = v;
+            else if(arg == "--max-line") stream_opt.max_line = (size_t)v;
+            else stream_opt.batch = (size_t)v;
+        }else if(arg == "--unordered"){
+            unordered = true;
+        }else if(arg == "--boards"){
+            std::string v = i+1 < argc ? argv[++i] : "";
+            if(v == "scalar") boards = BoardBackend::Scalar;
+            else if(v == "simd") boards = BoardBackend::Simd;
+            else{
+                std::cerr << "--boards expects scalar|simd\n";
+                return 1;
+            }
+        }else if(arg == "--engine"){
+            std::string v = i+1 < argc ? argv[++i] : "";
+            if(v == "cell") engine = Engine::Cell;
+            else if(v == "band") engine = Engine::Band;
+            else{
+                std::cerr << "--engine expects cell|band\n";
+                return 1;
+            }
+        }else if(arg == "--branching"){
+            std::string v = i+1 < argc ? argv[++i] : "";
+            if(v == "mrv") branching = Branching::Mrv;
+            else if(v == "wdeg") branching = Branching::Wdeg;
+            else{
+                std::cerr << "--branching expects mrv|wdeg\n";
+                return 1;
+            }
+        }else if(arg == "--restore"){
+            std::string v = i+1 < argc ? argv[++i] : "";
+            if(v == "trail") restore = RestoreMode::Trail;
+            else if(v == "snapshot") restore = RestoreMode::Snapshot;
+            else if(v == "hybrid") restore = RestoreMode::Hybrid;
+            else{
+                std::cerr << "--restore expects trail|snapshot|hybrid\n";
+                return 1;
+            }
+        }else if(arg == "--snapshot-depth"){
+            if(i+1 >= argc){
+                std::cerr << "--snapshot-depth requires a depth\n";
+                return 1;
+            }
+            snapshot_depth = std::atoi(argv[++i]);
+        }else if(arg == "--stats"){
+            std::string v = i+1 < argc ? argv[++i] : "";
+            if(v == "json") stats = StatsFormat::Json;
+            else if(v == "csv") stats = StatsFormat::Csv;
+            else{
+                std::cerr << "--stats expects json|csv\n";
+                return 1;
+            }
+        }else if(arg == "--infer"){
+            if(i+1 >= argc || !parse_inference(argv[++i], inference)){
+                std::cerr << "--infer expects all or a comma-separated list of "
+                             "claiming,naked-pairs,hidden-pairs,naked-triples,hidden-triples,xwing\n";
+                return 1;
+            }
         }else if(arg == "--dual-activation"){
             dual_enabled = true;
+        }else if(arg == "--portfolio"){
+            portfolio = true;
         }else{
             puzzle_arg = arg;
         }
     }
 
     SolverConfig cfg;
-    cfg.dual.enabled = dual_enabled;
+    if(!config_path.empty()){
+        std::string err;
+        if(!load_config_file(config_path, cfg, err)){
+            std::cerr << err << "\n";
+            return 1;
+        }
+    }
+    if(dual_enabled) cfg.dual.enabled = true;
+    cfg.boards = boards;
+    cfg.engine = engine;
+    cfg.branching = branching;
+    cfg.restore = restore;
+    cfg.inference = inference;
+    cfg.cache_entries = cache_entries;
+    cfg.tt_mb = tt_mb;
+    cfg.parallel = parallel;
+    cfg.limits = limits;
+    cfg.portfolio = portfolio;
+    if(snapshot_depth >= 0) cfg.snapshot_depth = snapshot_depth;
+    if(stats != StatsFormat::None && !cfg::kStats)
+        std::cerr << "built with CPPSOLVER_STATS=OFF: only nodes are counted\n";
+
+    if(stream_mode){
+        stream_opt.count_limit = count_limit;
+        StreamResult res = run_stream(cfg, stream_opt);
+        if(!res.io_ok) return 1;
+        return res.solved == res.puzzles ? 0 : 1;
+    }
 
     if(!file_path.empty()){
 
-        std::ifstream in(file_path);
-        if(!in){
-            std::cerr << "Failed to open " << file_path << "\n";
+        MappedFile in;
+        if(!in.open(file_path)){
+            std::cerr << "Failed to open " << file_path << ": " << std::strerror(errno) << "\n";
             return 1;
         }
+        PuzzleSource reader;
+        std::string err;
+        if(!reader.open(in.view(), err)){
+            std::cerr << file_path << ": " << err << "\n";
+            return 1;
+        }
+        PuzzleLine pl;
+        if(threads >= 0 || unordered || count_limit > 0){
+            std::vector<BatchPuzzle> puzzles;
+            while(reader.next(pl)) puzzles.push_back(BatchPuzzle{pl.line, pl.text, pl.packed});
+            if(timings_enabled) std::cerr << "--timings is ignored in threaded batch mode\n";
+            if(stats != StatsFormat::None && !benchmark_mode)
+                std::cerr << "--stats is only aggregated (with --benchmark) in threaded batch mode\n";
+            BatchOptions opt;
+            opt.threads = threads < 0 ? 1 : threads;
+            opt.ordered = !unordered;
+            opt.print = !benchmark_mode;
+            opt.count_limit = count_limit;
+            opt.record_latency = benchmark_mode;
+            BatchResult res = run_batch(puzzles, cfg, opt);
+            if(benchmark_mode){
+                print_batch_benchmark(res, cfg);
+                print_stats_aggregate(stats, res.puzzles, count_limit > 0 ? res.unique : res.solved, res.stats);
+            }
+            size_t good = count_limit > 0 ? res.unique : res.solved;
+            return good == res.puzzles && res.output_ok ? 0 : 1;
+        }
+
         SudokuSolver solver(cfg);
         bool all_ok = true;
-        std::string line;
         if(benchmark_mode){
-            double total_wall_ms = 0.0;
-            double total_cpu_ms = 0.0;
             size_t puzzles = 0;
             size_t solved = 0;
-            while(std::getline(in, line)){
-                std::string puzzle = trim(line);
-                if(puzzle.empty() || puzzle[0] == '#') continue;
+            size_t timeouts = 0;
+            uint64_t nodes = 0;
+            InferenceStats inference_stats;
+            TTStats tt_stats;
+            PortfolioStats portfolio_stats;
+            SolverStats search_stats;
+            timing::LatencyHistogram latency;
+            print_stats_header(std::cerr, stats, "line");
+            // One TSC read per puzzle; CPU time is taken once for the loop.
+            timing::ns_per_tick();
+            const uint64_t cpu_start = timing::process_cpu_ns();
+            uint64_t total_ticks = 0;
+            while(reader.next(pl)){
                 ++puzzles;
-                auto solve_wall_start = SteadyClock::now();
-                double solve_cpu_start = cpu_time_seconds();
-                bool ok = solver.solve(puzzle);
-                auto solve_wall_end = SteadyClock::now();
-                double solve_cpu_end = cpu_time_seconds();
-                total_wall_ms += wall_ms(solve_wall_start, solve_wall_end);
-                total_cpu_ms += (solve_cpu_end - solve_cpu_start) * 1000.0;
+                const uint64_t t0 = timing::ticks();
+                bool ok = solve_one(solver, pl);
+                const uint64_t dt = timing::ticks() - t0;
+                total_ticks += dt;
+                latency.add(timing::ticks_to_ns(dt));
+                nodes += solver.nodes();
+                inference_stats += solver.inference_stats();
+                tt_stats += solver.tt_stats();
+                portfolio_stats += solver.portfolio_stats();
+                search_stats += solver.stats();
+                if(stats != StatsFormat::None) print_stats(std::cerr, stats, "line", pl.line, ok, solver.stats());
                 if(ok) ++solved;
+                if(solver.result() == SolveResult::Timeout) ++timeouts;
                 all_ok = all_ok && ok;
             }
+            const double total_cpu_ms = timing::ns_to_ms(timing::process_cpu_ns() - cpu_start);
+            const double total_wall_ms = timing::ticks_to_ms(total_ticks);
             std::cout << "benchmark puzzles=" << puzzles
-                      << " solved=" << solved
+                      << " solved=" << solved;
+            if(cfg.limits.any()) std::cout << " timeouts=" << timeouts;
+            std::cout
+                      << " engine=" << engine_name(cfg.engine)
+                      << " boards=" << boards_name(cfg.boards)
+                      << " restore=" << restore_name(cfg.restore)
+                      << " nodes=" << nodes
                       << " wall_ms=" << total_wall_ms
                       << " cpu_ms=" << total_cpu_ms << "\n";
+            print_latency(latency);
+            print_cache_stats(solver.cache_stats(), cfg);
+            print_tt_stats(tt_stats, cfg);
+            print_portfolio_stats(portfolio_stats, cfg);
+            print_inference_stats(inference_stats, cfg.inference);
+            print_stats_aggregate(stats, puzzles, solved, search_stats);
         }else{
-            while(std::getline(in, line)){
-                std::string puzzle = trim(line);
-                if(puzzle.empty() || puzzle[0] == '#') continue;
-                bool ok = solve_and_print(solver, puzzle, timings_enabled);
+            OutputBuffer out;
+            print_stats_header(std::cerr, stats, "line");
+            while(reader.next(pl)){
+                bool ok = solve_and_print(solver, pl, timings_enabled, stats, out);
                 all_ok = all_ok && ok;
             }
+            if(!out.flush()) all_ok = false;
         }
         return all_ok ? 0 : 1;
     }
@@ -167,6 +848,18 @@ int main(int argc, char** argv){
          "...419..5"
          "....8..79");
 
-    bool ok = solve_and_print(solver, puzzle, timings_enabled);
+    OutputBuffer out;
+    print_stats_header(std::cerr, stats, "line");
+    if(count_limit > 0){
+        int cnt = solver.count_solutions(puzzle, count_limit);
+        if(solver.result() == SolveResult::Timeout) out.append(kTimeoutText);
+        else append_count(out, cnt, count_limit);
+        out.put('\n');
+        if(stats != StatsFormat::None) print_stats(std::cerr, stats, "line", 1, cnt == 1, solver.stats());
+        const bool written = out.flush();
+        return cnt == 1 && solver.result() != SolveResult::Timeout && written ? 0 : 1;
+    }
+    bool ok = solve_and_print(solver, PuzzleLine{1, puzzle}, timings_enabled, stats, out);
+    if(!out.flush()) ok = false;
     return ok ? 0 : 1;
 }
@@ -0,0 +1,45 @@
+#include "output_buffer.hpp"
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>
+
+OutputBuffer::OutputBuffer(int fd, size_t capacity) : fd_(fd), buf_(capacity < 256 ? 256 : capacity) {}
+
+OutputBuffer::~OutputBuffer(){ flush(); }
+
+void OutputBuffer::make_room(size_t n){
+    flush();
+    if(n > buf_.size()) buf_.resize(n);
+}
+
+void OutputBuffer::append(std::string_view s){
+    char* p = reserve(s.size());
+    std::memcpy(p, s.data(), s.size());
+    commit(s.size());
+}
+
+void OutputBuffer::append_uint(unsigned long long v){
+    char tmp[20];
+    int n = 0;
+    do { tmp[n++] = char('0' + v % 10); v /= 10; } while(v);
+    char* p = reserve(n);
+    for(int i = 0; i < n; ++i) p[i] = tmp[n - 1 - i];
+    commit(n);
+}
+
+bool OutputBuffer::flush(){
+    const char* p = buf_.data();
+    size_t left = len_;
+    while(left > 0){
+        ssize_t w = ::write(fd_, p, left);
+        if(w < 0){
+            if(errno == EINTR) continue;
+            ok_ = false;
+            break;
+        }
+        p += w;
+        left -= (size_t)w;
+    }
+    len_ = 0;
+    return ok_;
+}
@@ -0,0 +1,74 @@
+#include "packed.hpp"
+#include <cstring>
+
+namespace packed {
+namespace {
+inline void put_le(uint8_t* p, uint64_t v, int bytes){
+    for(int i = 0; i < bytes; ++i) p[i] = (uint8_t)(v >> (8 * i));
+}
+inline uint64_t get_le(const uint8_t* p, int bytes){
+    uint64_t v = 0;
+    for(int i = 0; i < bytes; ++i) v |= (uint64_t)p[i] << (8 * i);
+    return v;
+}
+} // namespace
+
+bool is_packed(std::string_view buf){
+    return buf.size() >= sizeof(kMagic) && std::memcmp(buf.data(), kMagic, sizeof(kMagic)) == 0;
+}
+
+void pack_grid(std::string_view text, uint8_t* rec){
+    std::memset(rec, 0, kRecordBytes);
+    const size_t n = text.size() < 81 ? text.size() : 81;
+    for(size_t i = 0; i < n; ++i){
+        char ch = text[i];
+        if(ch >= '1' && ch <= '9') rec[i >> 1] |= (uint8_t)((ch - '0') << ((i & 1) * 4));
+    }
+}
+
+void unpack_grid(const uint8_t* rec, char* out){
+    for(int i = 0; i < 81; ++i){
+        int v = cell(rec, i);
+        out[i] = (v >= 1 && v <= 9) ? char('0' + v) : '.';
+    }
+}
+
+void write_header(uint8_t* out, uint64_t count, uint16_t flags){
+    std::memcpy(out, kMagic, sizeof(kMagic));
+    put_le(out + 4, kVersion, 2);
+    put_le(out + 6, flags, 2);
+    put_le(out + 8, count, 8);
+}
+
+bool Reader::open(std::string_view buf, std::string& err){
+    *this = Reader{};
+    const auto* p = reinterpret_cast<const uint8_t*>(buf.data());
+    if(buf.size() < kHeaderBytes || !is_packed(buf)){
+        err = "not a packed puzzle file";
+        return false;
+    }
+    const uint64_t version = get_le(p + 4, 2);
+    const uint64_t flags = get_le(p + 6, 2);
+    const uint64_t count = get_le(p + 8, 8);
+    if(version != kVersion){
+        err = "unsupported packed version " + std::to_string(version);
+        return false;
+    }
+    // Guard the size arithmetic against a corrupt count.
+    const uint64_t per_record = kRecordBytes + ((flags & kHasIndex) ? 8 : 0);
+    if(count > (buf.size() - kHeaderBytes) / per_record ||
+       kHeaderBytes + count * per_record != buf.size()){
+        err = "packed file size does not match its header (" + std::to_string(count) + " records)";
+        return false;
+    }
+    records_ = p + kHeaderBytes;
+    count_ = count;
+    if(flags & kHasIndex) index_ = records_ + count * kRecordBytes;
+    return true;
+}
+
+uint64_t Reader::line(uint64_t i) const{
+    return index_ ? get_le(index_ + i * 8, 8) : i + 1;
+}
+
+} // namespace packed
@@ -0,0 +1,147 @@
+#include "parallel_search.hpp"
+#include "dfs.hpp"
+#include "propagation.hpp"
+#include "scoring.hpp"
+#include "trail.hpp"
+#include "work_queue.hpp"
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+namespace {
+constexpr size_t kTasksPerThread = 4;
+constexpr int kMaxSplitDepth = 6;
+
+// One subtree: the (cell, digit) choices that lead to it from the root.
+struct Task {
+    int n = 0;
+    uint8_t cell[kMaxSplitDepth];
+    uint8_t digit[kMaxSplitDepth];
+};
+
+// Collect the subtrees `levels` below S in dfs_single order; S is restored
+// afterwards. Returns true if S turned out solved on the way (S is then left
+// on the solution).
+bool expand(SolverState& S, const SolverConfig& cfg, Task& path, int levels, std::vector<Task>& out){
+    ++S.nodes;
+    if(S.is_solved()) return true;
+    if(levels == 0){
+        out.push_back(path);
+        return false;
+    }
+    int c = select_mrv_cell(S);
+    if(c < 0) return true;
+    int cand[9];
+    int n = ordered_candidates(S, cfg, c, cand);
+    const size_t mark = S.trail->mark();
+    for(int i = 0; i < n; ++i){
+        if(place_digit(S, c, cand[i]) && propagate(S)){
+            path.cell[path.n] = (uint8_t)c;
+            path.digit[path.n] = (uint8_t)cand[i];
+            ++path.n;
+            bool solved = expand(S, cfg, path, levels - 1, out);
+            --path.n;
+            if(solved) return true;
+        }
+        S.trail->undo_to(S, mark);
+    }
+    return false;
+}
+
+struct WorkerResult {
+    uint64_t nodes = 0;
+    SolverStats stats{};
+    InferenceStats inference{};
+    TTStats tt{};
+};
+} // namespace
+
+bool parallel_dfs(SolverState& S, const SolverConfig& cfg){
+    int threads = cfg.parallel.threads;
+    if(threads <= 0) threads = (int)std::max(1u, std::thread::hardware_concurrency());
+
+    // Split one level deeper at a time until every worker has a few subtrees.
+    std::vector<Task> tasks;
+    for(int levels = 1; levels <= kMaxSplitDepth; ++levels){
+        tasks.clear();
+        Task path;
+        if(expand(S, cfg, path, levels, tasks)) return true;
+        if(tasks.size() >= (size_t)threads * kTasksPerThread) break;
+    }
+    if(tasks.empty()) return false;
+    threads = (int)std::min<size_t>((size_t)threads, tasks.size());
+
+    // Round-robin keeps the most promising subtrees at the front of every queue.
+    std::vector<WorkQueue<size_t>> queues(threads);
+    for(size_t i = 0; i < tasks.size(); ++i) queues[i % threads].push(i);
+
+    // done stops every worker: set by the first solution or by a worker that
+    // ran into one of S's limits (the whole search is then a timeout).
+    std::atomic<bool> done{false};
+    std::atomic<bool> found{false};
+    std::atomic<bool> limit_hit{false};
+    std::vector<WorkerResult> results(threads);
+    SolverState solution;
+    // Whatever is left of the node limit is shared out evenly.
+    uint64_t worker_nodes = 0;
+    if(S.node_limit) worker_nodes = std::max<uint64_t>(1, (S.node_limit - std::min(S.node_limit, S.nodes)) / threads);
+
+    auto worker = [&](int id){
+        SolverState W = S;
+        Trail trail;
+        trail.reserve(1 << 14);
+        trail.snapshots.resize(S.trail->snapshots.size());
+        W.trail = &trail;
+        W.stop = &done;
+        W.node_limit = worker_nodes; // trail_limit and deadline carry over
+        W.aborted = false;
+        W.nodes = 0;
+        W.stats = SolverStats{};
+        W.inference_stats = InferenceStats{};
+        W.tt_stats = TTStats{}; // the table itself is shared
+
+        size_t t;
+        while(!done.load(std::memory_order_relaxed)){
+            bool got = queues[id].pop(t);
+            for(int k = 1; !got && k < threads; ++k) got = queues[(id + k) % threads].steal(t);
+            if(!got) break;
+
+            const Task& task = tasks[t];
+            bool ok = true;
+            for(int k = 0; ok && k < task.n; ++k)
+                ok = place_digit(W, task.cell[k], task.digit[k]) && propagate(W);
+            if(ok && dfs_single(W, cfg)){
+                if(!found.exchange(true)) solution = W;
+                done = true;
+                break;
+            }
+            W.trail->undo_to(W, 0);
+            if(W.aborted){
+                limit_hit = true;
+                done = true;
+                break;
+            }
+        }
+        results[id] = WorkerResult{W.nodes, W.stats, W.inference_stats, W.tt_stats};
+    };
+
+    std::vector<std::thread> pool;
+    pool.reserve(threads);
+    for(int t = 0; t < threads; ++t) pool.emplace_back(worker, t);
+    for(auto& th : pool) th.join();
+
+    for(const auto& r : results){
+        S.nodes += r.nodes;
+        S.stats += r.stats;
+        S.inference_stats += r.inference;
+        S.tt_stats += r.tt;
+    }
+    if(!found){
+        S.aborted = limit_hit.load();
+        return false;
+    }
+    S.cell_value = solution.cell_value;
+    S.cell_mask = solution.cell_mask;
+    S.open = solution.open;
+    return true;
+}
@@ -0,0 +1,83 @@
+#include "portfolio.hpp"
+#include "dfs.hpp"
+#include "trail.hpp"
+#include <thread>
+#include <vector>
+
+const char* portfolio_strategy_name(int i){
+    switch(i){
+    case 0: return "single";
+    case 1: return "dual";
+    case 2: return "dual-early";  // py branching from depth 2 to 12
+    case 3: return "dual-loose";  // py also after productive propagation, px up to 3
+    default: return "?";
+    }
+}
+
+DualConfig portfolio_strategy(int i){
+    DualConfig d;
+    d.enabled = i != 0;
+    if(i == 2){
+        d.min_depth = 2;
+        d.max_depth = 12;
+    }else if(i == 3){
+        d.require_flat_prop = false;
+        d.max_mrv_px = 3;
+    }
+    return d;
+}
+
+namespace {
+struct Racer {
+    SolverState state;
+    Trail trail;
+    bool ok = false;
+};
+} // namespace
+
+bool portfolio_dfs(SolverState& S, const SolverConfig& cfg, int& winner){
+    std::atomic<bool> done{false};
+    std::atomic<int> first{-1};
+    std::vector<Racer> racers(kPortfolioStrategies);
+
+    auto race = [&](int id){
+        Racer& r = racers[id];
+        SolverConfig c = cfg;
+        c.dual = portfolio_strategy(id);
+        r.state = S;
+        r.trail.reserve(1 << 14);
+        r.trail.snapshots.resize(S.trail->snapshots.size());
+        r.state.trail = &r.trail;
+        r.state.stop = &done;
+        r.state.nodes = 0;
+        r.state.stats = SolverStats{};
+        r.state.inference_stats = InferenceStats{};
+        r.state.tt_stats = TTStats{}; // the table itself is shared
+        r.ok = c.dual.enabled ? dfs_dual(r.state, c) : dfs_single(r.state, c);
+        // An aborted search (stopped, or out of budget) decided nothing.
+        if(r.state.aborted) return;
+        int none = -1;
+        if(first.compare_exchange_strong(none, id)) done = true;
+    };
+
+    std::vector<std::thread> pool;
+    pool.reserve(kPortfolioStrategies - 1);
+    for(int i = 1; i < kPortfolioStrategies; ++i) pool.emplace_back(race, i);
+    race(0);
+    for(auto& th : pool) th.join();
+
+    winner = first.load();
+    if(winner < 0){
+        S.aborted = true;
+        return false;
+    }
+    const SolverState& w = racers[winner].state;
+    S.cell_value = w.cell_value;
+    S.cell_mask = w.cell_mask;
+    S.open = w.open;
+    S.nodes += w.nodes;
+    S.stats += w.stats;
+    S.inference_stats += w.inference_stats;
+    S.tt_stats += w.tt_stats;
+    return racers[winner].ok;
+}
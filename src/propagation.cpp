@@ -1,6 +1,8 @@
 #include "propagation.hpp"
 #include "trail.hpp"
 #include "geometry.hpp"
+#include "board_simd.hpp"
+#include "inference.hpp"
 #include <cassert>
 
 using geom::Bits81;
@@ -23,29 +25,48 @@ static inline void enqueue_lock(SolverState& S, int box, int d){
     if(!S.enq_lock[idx]){ S.enq_lock[idx]=1; S.q_lock.push_back((box<<4)|d); }
 }
 
+// Branching::Wdeg: every unit behind a contradiction (one left without a
+// place for a digit, or all three of a cell left without candidates) gains
+// conflict weight, then the bump grows for the next conflict.
+static inline void wdeg_unit(SolverState& S, int u){
+    if(S.wdeg) S.unit_weight[u] += S.wdeg_bump;
+}
+static inline void wdeg_cell(SolverState& S, int c){
+    for(int u : geom::CELL_UNITS[c]) wdeg_unit(S, u);
+}
+static inline void wdeg_conflict(SolverState& S){
+    if(S.wdeg) note_conflict(S);
+}
+
 bool eliminate_digit(SolverState& S, int c, int d){
+    if constexpr(cfg::kStats) ++S.stats.elim_calls;
     uint16_t m = S.cell_mask[c];
     uint16_t bit = 1u<<d;
     if((m & bit)==0) return true; // already eliminated
 
     // Trail and update cell mask
     S.trail->push_elim(c, d, m);
+    if(!S.cell_value[c]) mrv_move(S, c, m, (uint16_t)(m & ~bit));
     m &= ~bit;
     S.cell_mask[c] = m;
 
     // Clear B[d] bit
     if(c<64) S.B[d].lo &= ~(1ULL<<c); else S.B[d].hi &= ~(1ULL<<(c-64));
 
-    // Update unit counts (three units for cell c)
+    // Update unit counts (three units for cell c). A unit left with no place
+    // for d is a contradiction, reported once all three counters are updated
+    // so that undo_to finds them consistent.
     const auto& U = geom::CELL_UNITS[c];
+    bool dead = false;
     for(int ui=0; ui<3; ++ui){
         int u = U[ui];
         int newcnt = --S.unit_digit_count[u][d];
         if(newcnt == 1) enqueue_l1(S, u, d);
-        if(newcnt < 0){ S.contradiction=true; return false; }
+        if(newcnt <= 0){ dead = true; wdeg_unit(S, u); }
     }
+    if(dead){ wdeg_conflict(S); S.contradiction=true; return false; }
     // No candidates left
-    if(m == 0u){ S.contradiction=true; return false; }
+    if(m == 0u){ wdeg_cell(S, c); wdeg_conflict(S); S.contradiction=true; return false; }
 
     // If mask is a single, enqueue L4 placement
     if((m & (m-1)) == 0) enqueue_l4(S, c);
@@ -56,7 +77,47 @@ bool eliminate_digit(SolverState& S, int c, int d){
     return true;
 }
 
+// place_digit's peer step on simd boards. The board, the MRV buckets and the
+// singles/dead-end checks are done for all affected peers at once: each open
+// one loses d, so it moves down one bucket, and those landing in bucket 1 or 0
+// are the new naked singles and dead ends. Only the trail, masks and unit
+// counters are per peer (undo_to works per entry). Everything is updated
+// before a contradiction is reported.
+static bool eliminate_from_peers_simd(SolverState& S, int d, Bits81 affected){
+    simd::clear_cells(S.B[d], affected);
+    simd::move_down(S.mrv_bucket, band(affected, S.open));
+    bool dead = false;
+    for(Bits81 a = affected; any(a);){
+        int p = ctz(a);
+        geom::clr_bit(a, p);
+        uint16_t pm = S.cell_mask[p];
+        S.trail->push_elim(p, d, pm);
+        S.cell_mask[p] = (uint16_t)(pm & ~(1u<<d));
+        for(int u : geom::CELL_UNITS[p]){
+            int newcnt = --S.unit_digit_count[u][d];
+            if(newcnt == 1) enqueue_l1(S, u, d);
+            if(newcnt <= 0){ dead = true; wdeg_unit(S, u); }
+        }
+        enqueue_lock(S, geom::BOX[p], d);
+    }
+    // Emptied: open cells now in bucket 0, or a placed peer holding d.
+    Bits81 empty = band(affected, bor(S.mrv_bucket[0], bnot(S.open)));
+    if(dead || any(empty)){
+        if(!dead && S.wdeg) for(Bits81 e = empty; any(e);){ int p = ctz(e); geom::clr_bit(e, p); wdeg_cell(S, p); }
+        wdeg_conflict(S);
+        S.contradiction=true;
+        return false;
+    }
+    for(Bits81 s = band(affected, S.mrv_bucket[1]); any(s);){
+        int p = ctz(s);
+        geom::clr_bit(s, p);
+        enqueue_l4(S, p);
+    }
+    return true;
+}
+
 bool place_digit(SolverState& S, int c, int d){
+    if constexpr(cfg::kStats) ++S.stats.place_calls;
     // If already placed with same digit, ok; if placed differently -> contradiction
     if (S.cell_value[c]) {
         if (S.cell_value[c] != d + 1){ S.contradiction=true; return false; }
@@ -66,27 +127,36 @@ bool place_digit(SolverState& S, int c, int d){
     if(((old>>d)&1u)==0){ S.contradiction=true; return false; }
     // Trail entry remembers old mask; we enforce the single after wiping other digits
     S.trail->push_place(c, d, old);
+    S.hash ^= zobrist::key(c, d);
 
-<<<<<<< HEAD
     // Update this cell to singleton {d} WITHOUT creating per-digit trail entries.
     // We directly update B[] and unit_digit_count for the digits removed from this cell.
     uint16_t newm = (uint16_t)(1u<<d);
+    // Another digit left without a place in one of c's units. Reported once
+    // the placement is complete, which is the state undo_to expects.
+    bool dead = false;
+    const bool simd_boards = S.boards == BoardBackend::Simd;
     if(old != newm){
         uint16_t removed = (uint16_t)(old & (uint16_t)~newm); // other digits removed from this cell
         const auto& U = geom::CELL_UNITS[c];
+        // Simd: clear c from the other eight boards in one pass; the loop below
+        // then only maintains the unit counters.
+        if(simd_boards) simd::clear_cells_except(S.B, geom::cell_bit(c), d);
         while(removed){
             int x = __builtin_ctz((unsigned)removed);
             removed &= (uint16_t)(removed - 1);
 
             // Clear candidate x for this cell in B[x]
-            if(c<64) S.B[x].lo &= ~(1ULL<<c); else S.B[x].hi &= ~(1ULL<<(c-64));
+            if(!simd_boards){
+                if(c<64) S.B[x].lo &= ~(1ULL<<c); else S.B[x].hi &= ~(1ULL<<(c-64));
+            }
 
             // Update unit counts for digit x in the 3 units of cell c
             for(int ui=0; ui<3; ++ui){
                 int u = U[ui];
                 int newcnt = --S.unit_digit_count[u][x];
                 if(newcnt == 1) enqueue_l1(S, u, x);
-                if(newcnt < 0){ S.contradiction=true; return false; }
+                if(newcnt <= 0){ dead = true; wdeg_unit(S, u); }
             }
             // Box-local distribution changed for digit x: enqueue lock check
             enqueue_lock(S, geom::BOX[c], x);
@@ -94,23 +164,13 @@ bool place_digit(SolverState& S, int c, int d){
     }
     S.cell_mask[c] = newm;
     S.cell_value[c] = (uint8_t)(d+1);
+    geom::clr_bit(S.open, c);
+    geom::clr_bit(S.mrv_bucket[popcount9(old)], c);
+    if(dead){ wdeg_conflict(S); S.contradiction=true; return false; }
 // Eliminate d from peers
-=======
-    // Remove other digits from this cell (update counts/B and possibly L1)
-    for(int x=0; x<9; ++x){
-        if(x==d) continue;
-        if((old>>x)&1u){
-            if(!eliminate_digit(S, c, x)) return false;
-        }
-    }
-    // Now enforce single mask and set value
-    S.cell_mask[c] = (uint16_t)(1u<<d);
-    S.cell_value[c] = (uint8_t)(d+1);
-
-    // Eliminate d from peers
->>>>>>> origin/main
     auto peers = geom::PEER_MASK[c];
     Bits81 affected = geom::band(S.B[d], peers); // cells that currently still allow d among peers
+    if(simd_boards) return eliminate_from_peers_simd(S, d, affected);
 
     // Iterate affected peers to update their cell masks and counters/events
     while(geom::any(affected)){
@@ -121,6 +181,7 @@ bool place_digit(SolverState& S, int c, int d){
         uint16_t pm = S.cell_mask[p];
         if(pm & (1u<<d)){
             S.trail->push_elim(p, d, pm);
+            if(!S.cell_value[p]) mrv_move(S, p, pm, (uint16_t)(pm & ~(1u<<d)));
             pm &= ~(1u<<d);
             S.cell_mask[p] = pm;
             if(p<64) S.B[d].lo &= ~(1ULL<<p); else S.B[d].hi &= ~(1ULL<<(p-64));
@@ -129,9 +190,10 @@ bool place_digit(SolverState& S, int c, int d){
                 int u = U[ui];
                 int newcnt = --S.unit_digit_count[u][d];
                 if(newcnt == 1) enqueue_l1(S, u, d);
-                if(newcnt < 0){ S.contradiction=true; return false; }
+                if(newcnt <= 0){ dead = true; wdeg_unit(S, u); }
             }
-            if(pm == 0u){ S.contradiction=true; return false; }
+            if(dead){ wdeg_conflict(S); S.contradiction=true; return false; }
+            if(pm == 0u){ wdeg_cell(S, p); wdeg_conflict(S); S.contradiction=true; return false; }
             if((pm & (pm-1)) == 0) enqueue_l4(S, p);
             enqueue_lock(S, geom::BOX[p], d);
         }
@@ -215,9 +277,8 @@ static bool process_lock_event(SolverState& S, int b, int d){
     return true;
 }
 
-bool propagate(SolverState& S){
-    // Drain queues to fixpoint
-    S.last_prop_placements = 0;
+// Drain the single/lock queues to a fixpoint.
+static bool propagate_singles(SolverState& S){
     int c;
     int u,d, b;
     while(true){
@@ -239,24 +300,21 @@ bool propagate(SolverState& S){
             auto mask = geom::band(S.B[d], geom::UNIT_MASK[u]);
             if(geom::any(mask)){
                 int cell = geom::ctz(mask);
-<<<<<<< HEAD
                 // guard: do not double-place (L1 can be queued for already-fixed digits)
                 if(!S.cell_value[cell]){
                     if(!place_digit(S, cell, d)) return false;
                     ++S.last_prop_placements;
                     progressed=true;
                 }
-=======
-                if(!place_digit(S, cell, d)) return false;
-                ++S.last_prop_placements;
-                progressed=true;
->>>>>>> origin/main
             }
         }
         if(S.contradiction) return false;
 
         while(try_pop_lock(S, b, d) && !S.contradiction){
+            size_t before = 0;
+            if constexpr(cfg::kStats){ ++S.stats.lock_events; before = S.trail->mark(); }
             if(!process_lock_event(S, b, d)) return false;
+            if constexpr(cfg::kStats){ if(S.trail->mark() != before) ++S.stats.lock_productive; }
             progressed=true; // may be false if no lock existed; harmless
         }
         if(S.contradiction) return false;
@@ -265,3 +323,16 @@ bool propagate(SolverState& S){
     }
     return true;
 }
+
+bool propagate(SolverState& S){
+    S.last_prop_placements = 0;
+    // Stronger stages only run on a singles fixpoint; their eliminations
+    // enqueue ordinary events, so go back to the cheap rules after each hit.
+    while(true){
+        if(!propagate_singles(S)) return false;
+        if(!S.inference) return true;
+        int r = run_inference(S);
+        if(r < 0) return false;
+        if(r == 0) return true;
+    }
+}
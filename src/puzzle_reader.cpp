@@ -0,0 +1,75 @@
+#include "puzzle_reader.hpp"
+#include <cctype>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+MappedFile::~MappedFile(){ close(); }
+
+bool MappedFile::open(const std::string& path){
+    close();
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if(fd < 0) return false;
+    struct stat st{};
+    if(fstat(fd, &st) != 0){ ::close(fd); return false; }
+    size_t sz = (size_t)st.st_size;
+    if(sz == 0){ ::close(fd); return true; } // empty file: empty view, nothing mapped
+    void* p = mmap(nullptr, sz, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if(p == MAP_FAILED) return false;
+    // One sequential pass over the file: let the kernel read ahead aggressively.
+    madvise(p, sz, MADV_SEQUENTIAL);
+    data_ = static_cast<const char*>(p);
+    size_ = sz;
+    return true;
+}
+
+void MappedFile::close(){
+    if(data_) munmap(const_cast<char*>(data_), size_);
+    data_ = nullptr;
+    size_ = 0;
+}
+
+std::string_view trim_view(std::string_view in){
+    size_t start = 0;
+    while(start < in.size() && std::isspace(static_cast<unsigned char>(in[start]))) ++start;
+    size_t end = in.size();
+    while(end > start && std::isspace(static_cast<unsigned char>(in[end-1]))) --end;
+    return in.substr(start, end - start);
+}
+
+bool PuzzleLineReader::next(PuzzleLine& out){
+    while(pos_ < buf_.size()){
+        const char* base = buf_.data() + pos_;
+        const void* nl = std::memchr(base, '\n', buf_.size() - pos_);
+        size_t len = nl ? (size_t)(static_cast<const char*>(nl) - base) : buf_.size() - pos_;
+        std::string_view raw(base, len);
+        pos_ += len + (nl ? 1 : 0);
+        ++line_;
+        std::string_view t = trim_view(raw);
+        if(t.empty() || t[0] == '#') continue;
+        out.line = line_;
+        out.text = t;
+        return true;
+    }
+    return false;
+}
+
+bool PuzzleSource::open(std::string_view buf, std::string& err){
+    pos_ = 0;
+    is_packed_ = packed::is_packed(buf);
+    if(is_packed_) return packed_.open(buf, err);
+    text_ = PuzzleLineReader(buf);
+    return true;
+}
+
+bool PuzzleSource::next(PuzzleLine& out){
+    if(!is_packed_) return text_.next(out);
+    if(pos_ >= packed_.size()) return false;
+    out.line = packed_.line(pos_);
+    out.text = std::string_view();
+    out.packed = packed_.record(pos_++);
+    return true;
+}
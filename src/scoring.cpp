@@ -1,5 +1,6 @@
 #include "scoring.hpp"
 #include "geometry.hpp"
+#include "board_simd.hpp"
 #include <algorithm>
 
 void compute_scarcity(SolverState& S){
@@ -8,14 +9,34 @@ void compute_scarcity(SolverState& S){
     }
 }
 
+// Lowest non-empty bucket; among its cells the one whose units carry the most
+// conflict weight (lowest index on ties and for buckets 0 and 1).
+static int select_wdeg_cell(const SolverState& S){
+    for(int k=0; k<=9; ++k){
+        geom::Bits81 M = S.mrv_bucket[k];
+        if(!geom::any(M)) continue;
+        int best = geom::ctz(M);
+        if(k <= 1) return best;
+        float best_w = -1.0f;
+        while(geom::any(M)){
+            int c = geom::ctz(M);
+            if(c<64) M.lo &= (M.lo-1); else M.hi &= (M.hi-1);
+            const auto& U = geom::CELL_UNITS[c];
+            float w = S.unit_weight[U[0]] + S.unit_weight[U[1]] + S.unit_weight[U[2]];
+            if(w > best_w){ best_w = w; best = c; }
+        }
+        return best;
+    }
+    return -1; // all filled
+}
+
 int select_mrv_cell(const SolverState& S){
-    int best=-1, bestw=10;
-    for(int c=0;c<81;++c){
-        if(S.cell_value[c]) continue;
-        int w = __builtin_popcount((unsigned)S.cell_mask[c]);
-        if(w < bestw){ bestw=w; best=c; if(w==1) break; }
+    if(S.wdeg) return select_wdeg_cell(S);
+    // Lowest non-empty bucket, lowest index within it (same pick as a full scan).
+    for(int k=0; k<=9; ++k){
+        if(geom::any(S.mrv_bucket[k])) return geom::ctz(S.mrv_bucket[k]);
     }
-    return best; // -1 means all filled
+    return -1; // all filled
 }
 
 void generate_candidates(const SolverState& S, int cell, std::vector<int>& out){
@@ -38,16 +59,16 @@ void generate_candidates_from_mask(uint16_t mask, std::vector<int>& out){
     }
 }
 
-float score_digit(const SolverState& S, int cell, int d){
+float score_digit(const SolverState& S, int cell, int d, const ScoringConfig& w){
     // Influence approximation: how many peers currently allow digit d
     int inf = geom::popcnt( geom::band(S.B[d], geom::PEER_MASK[cell]) );
     // Scarcity: fewer cells -> prefer
     int sc  = S.scarcity[d];
-    // Simple linear combination (tunable)
-    return 2.0f * (float)inf + -1.0f * (float)sc;
+    // Simple linear combination (SolverConfig::scoring)
+    return w.influence * (float)inf + w.scarcity * (float)sc;
 }
 
-int select_pressure_cell(const SolverState& S, int px){
+int select_pressure_cell(const SolverState& S, int px, const ScoringConfig& w){
     int best_py = -1;
     float best_score = -1e9f;
 
@@ -69,7 +90,7 @@ int select_pressure_cell(const SolverState& S, int px){
 
         int overlap = geom::popcnt( geom::band(geom::PEER_MASK[px], geom::PEER_MASK[c]) );
 
-        float score = 3.0f * (float)shared + 2.0f * (float)overlap - 1.0f * (float)mrv;
+        float score = w.shared_units * (float)shared + w.overlap * (float)overlap + w.mrv * (float)mrv;
         if(score > best_score){
             best_score = score;
             best_py = c;
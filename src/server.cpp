@@ -0,0 +1,555 @@
+#include "server.hpp"
+#include "solver.hpp"
+#include "output_buffer.hpp"
+#include "puzzle_reader.hpp"
+#include "timing.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>
+#include <csignal>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/signalfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+
+// epoll tags below kFirstConn; connections get increasing ids from there.
+enum : uint64_t { kUnixListener = 1, kTcpListener, kWake, kSignal, kFirstConn = 16 };
+
+struct Job {
+    uint64_t conn = 0;
+    uint64_t seq = 0;
+    std::vector<std::string> puzzles;
+    uint64_t received_ns = 0;
+};
+
+struct Done {
+    uint64_t conn = 0;
+    uint64_t seq = 0;
+    std::string response;
+};
+
+class JobQueue {
+public:
+    void push(Job&& j){
+        {
+            std::lock_guard<std::mutex> lk(m_);
+            q_.push_back(std::move(j));
+        }
+        cv_.notify_one();
+    }
+    // Blocks; false once stopped.
+    bool pop(Job& out){
+        std::unique_lock<std::mutex> lk(m_);
+        cv_.wait(lk, [&]{ return stopped_ || !q_.empty(); });
+        if(stopped_) return false;
+        out = std::move(q_.front());
+        q_.pop_front();
+        return true;
+    }
+    void stop(){
+        {
+            std::lock_guard<std::mutex> lk(m_);
+            stopped_ = true;
+        }
+        cv_.notify_all();
+    }
+private:
+    std::mutex m_;
+    std::condition_variable cv_;
+    std::deque<Job> q_;
+    bool stopped_ = false;
+};
+
+struct Conn {
+    int fd = -1;
+    std::string in;                       // bytes not yet parsed
+    std::vector<std::string> current;     // puzzles of the request being read
+    uint64_t next_seq = 0;                // seq of the next request
+    uint64_t send_seq = 0;                // seq of the next response to write
+    std::map<uint64_t, std::string> ready; // finished, waiting for earlier seqs
+    std::string out;
+    size_t out_pos = 0;
+    size_t ready_bytes = 0;               // total size of ready
+    size_t inflight = 0;
+    uint32_t events = 0;                  // currently registered with epoll
+    bool rejecting = false;               // skipping the rest of an oversized request
+    bool paused = false;                  // complete lines left in `in` while throttled
+    bool peer_closed = false;             // (or we stopped reading: line too long)
+};
+
+void append_num(std::string& s, uint64_t v){
+    char tmp[20];
+    int n = 0;
+    do { tmp[n++] = char('0' + v % 10); v /= 10; } while(v);
+    while(n) s.push_back(tmp[--n]);
+}
+
+std::string solve_request(SudokuSolver& solver, const Job& job, int count_limit){
+    const uint64_t start_ns = timing::mono_ns();
+    std::string r;
+    r.reserve(job.puzzles.size() * 82 + 80);
+    size_t solved = 0;
+    char sol[81];
+    for(const auto& p : job.puzzles){
+        if(count_limit > 0){
+            int cnt = solver.count_solutions(p, count_limit);
+            const bool timeout = solver.result() == SolveResult::Timeout;
+            if(cnt == 1 && !timeout) ++solved;
+            if(timeout) r += kTimeoutText;
+            else if(count_limit >= 2 && cnt >= count_limit) r += "many";
+            else append_num(r, (uint64_t)cnt);
+        }else if(solver.solve(p)){
+            ++solved;
+            solver.solution_into(sol);
+            r.append(sol, 81);
+        }else{
+            r += solver.result() == SolveResult::Timeout ? kTimeoutText : kUnsolvedText;
+        }
+        r.push_back('\n');
+    }
+    const uint64_t end_ns = timing::mono_ns();
+    r += "# puzzles=";
+    append_num(r, job.puzzles.size());
+    r += " solved=";
+    append_num(r, solved);
+    r += " queue_us=";
+    append_num(r, (start_ns - job.received_ns) / 1000);
+    r += " solve_us=";
+    append_num(r, (end_ns - start_ns) / 1000);
+    r += "\n\n";
+    return r;
+}
+
+int listen_unix(const std::string& path){
+    sockaddr_un addr{};
+    if(path.size() >= sizeof(addr.sun_path)){
+        errno = ENAMETOOLONG;
+        return -1;
+    }
+    int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if(fd < 0) return -1;
+    addr.sun_family = AF_UNIX;
+    std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+    ::unlink(path.c_str()); // stale socket from an earlier run
+    if(::bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 || ::listen(fd, SOMAXCONN) < 0){
+        int e = errno;
+        ::close(fd);
+        errno = e;
+        return -1;
+    }
+    return fd;
+}
+
+int listen_tcp(int port){
+    int fd = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if(fd < 0) return -1;
+    int one = 1;
+    ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons((uint16_t)port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if(::bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 || ::listen(fd, SOMAXCONN) < 0){
+        int e = errno;
+        ::close(fd);
+        errno = e;
+        return -1;
+    }
+    return fd;
+}
+
+class Server {
+public:
+    Server(const SolverConfig& cfg, const ServeOptions& opt) : cfg_(cfg), opt_(opt) {
+        if(cfg.tt_mb) tt_ = std::make_shared<TranspositionTable>(cfg.tt_mb);
+    }
+    int run();
+
+private:
+    bool add(int fd, uint64_t tag, uint32_t events){
+        epoll_event ev{};
+        ev.events = events;
+        ev.data.u64 = tag;
+        return ::epoll_ctl(ep_, EPOLL_CTL_ADD, fd, &ev) == 0;
+    }
+    void accept_all(int listener, bool tcp);
+    bool shed(int listener);
+    void set_listening(bool on);
+    bool throttled(const Conn& c) const {
+        return c.inflight >= opt_.max_inflight ||
+               c.ready_bytes + (c.out.size() - c.out_pos) >= opt_.max_output;
+    }
+    void on_readable(uint64_t id, Conn& c);
+    void parse(uint64_t id, Conn& c);
+    void consume(uint64_t id, Conn& c);
+    void add_ready(Conn& c, uint64_t seq, std::string response);
+    void submit(uint64_t id, Conn& c);
+    void drain_completions();
+    void pump(uint64_t id, Conn& c);   // move ready responses to out, write
+    void close_conn(uint64_t id);
+    void worker();
+
+    const SolverConfig& cfg_;
+    const ServeOptions& opt_;
+    std::shared_ptr<TranspositionTable> tt_; // one for all workers
+    int ep_ = -1;
+    int wake_fd_ = -1;
+    int unix_fd_ = -1;
+    int tcp_fd_ = -1;
+    int spare_fd_ = -1;                  // given up to shed a connection at EMFILE
+    bool listening_ = true;
+    JobQueue jobs_;
+    std::mutex done_mu_;
+    std::vector<Done> done_;
+    std::unordered_map<uint64_t, Conn> conns_;
+    uint64_t next_id_ = kFirstConn;
+    uint64_t requests_ = 0;
+    uint64_t puzzles_ = 0;
+    uint64_t shed_ = 0;
+};
+
+void Server::worker(){
+    SudokuSolver solver(cfg_, tt_);
+    Job job;
+    while(jobs_.pop(job)){
+        Done d{job.conn, job.seq, solve_request(solver, job, opt_.count_limit)};
+        {
+            std::lock_guard<std::mutex> lk(done_mu_);
+            done_.push_back(std::move(d));
+        }
+        uint64_t one = 1;
+        ssize_t w = ::write(wake_fd_, &one, sizeof(one));
+        (void)w;
+    }
+}
+
+void Server::accept_all(int listener, bool tcp){
+    while(true){
+        int fd = ::accept4(listener, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if(fd < 0){
+            if((errno == EMFILE || errno == ENFILE) && shed(listener)) continue;
+            return; // EAGAIN, or a transient error: wait for the next event
+        }
+        if(tcp){
+            int one = 1;
+            ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        }
+        uint64_t id = next_id_++;
+        if(!add(fd, id, EPOLLIN | EPOLLRDHUP)){
+            ::close(fd);
+            continue;
+        }
+        Conn& c = conns_[id];
+        c.fd = fd;
+        c.events = EPOLLIN | EPOLLRDHUP;
+    }
+}
+
+// Out of descriptors: the pending connection keeps the level-triggered
+// listener readable, so returning would spin. Free the spare descriptor to
+// accept the connection and close it at once; without a spare, stop polling
+// the listeners until a connection closes.
+bool Server::shed(int listener){
+    if(spare_fd_ >= 0){
+        ::close(spare_fd_);
+        int fd = ::accept4(listener, nullptr, nullptr, SOCK_CLOEXEC);
+        if(fd >= 0) ::close(fd);
+        spare_fd_ = ::open("/dev/null", O_RDONLY | O_CLOEXEC);
+        if(fd >= 0){
+            ++shed_;
+            return true;
+        }
+    }
+    set_listening(false);
+    return false;
+}
+
+void Server::set_listening(bool on){
+    for(auto [fd, tag] : {std::pair<int, uint64_t>{unix_fd_, kUnixListener}, {tcp_fd_, kTcpListener}}){
+        if(fd < 0) continue;
+        epoll_event ev{};
+        ev.events = on ? uint32_t(EPOLLIN) : 0u;
+        ev.data.u64 = tag;
+        ::epoll_ctl(ep_, EPOLL_CTL_MOD, fd, &ev);
+    }
+    listening_ = on;
+}
+
+void Server::add_ready(Conn& c, uint64_t seq, std::string response){
+    c.ready_bytes += response.size();
+    c.ready[seq] = std::move(response);
+}
+
+void Server::submit(uint64_t id, Conn& c){
+    Job job;
+    job.conn = id;
+    job.seq = c.next_seq++;
+    job.puzzles.swap(c.current);
+    job.received_ns = timing::mono_ns();
+    ++requests_;
+    puzzles_ += job.puzzles.size();
+    ++c.inflight;
+    jobs_.push(std::move(job));
+}
+
+// Submit the complete requests in c.in. Leaves lines in place (c.paused)
+// while throttled.
+void Server::parse(uint64_t id, Conn& c){
+    size_t pos = 0;
+    c.paused = false;
+    while(true){
+        size_t nl = c.in.find('\n', pos);
+        if(nl == std::string::npos) break;
+        if(throttled(c)){
+            c.paused = true;
+            break;
+        }
+        if(nl - pos > opt_.max_line) break;
+        std::string_view line = trim_view(std::string_view(c.in).substr(pos, nl - pos));
+        pos = nl + 1;
+        if(line.empty()){
+            if(c.rejecting) c.rejecting = false;
+            else if(!c.current.empty()) submit(id, c);
+            continue;
+        }
+        if(line.front() == '#' || c.rejecting) continue;
+        if(c.current.size() >= opt_.max_request){
+            // Answer in order with an error and skip the rest of this request.
+            c.current.clear();
+            c.rejecting = true;
+            add_ready(c, c.next_seq++, "# error=request too large\n\n");
+            continue;
+        }
+        c.current.emplace_back(line);
+    }
+    if(!c.paused && c.in.size() - pos > opt_.max_line){
+        // No puzzle line is that long: answer in order, then stop reading and
+        // close once the answers are out.
+        c.current.clear();
+        c.in.clear();
+        c.rejecting = false;
+        c.peer_closed = true;
+        add_ready(c, c.next_seq++, "# error=line too long\n\n");
+        return;
+    }
+    c.in.erase(0, pos);
+}
+
+// parse(), and after EOF the final request, which still gets an answer
+// without its blank line.
+void Server::consume(uint64_t id, Conn& c){
+    parse(id, c);
+    if(!c.peer_closed || c.paused) return;
+    if(!c.in.empty()){
+        c.in.push_back('\n');
+        parse(id, c);
+        if(c.paused) return;
+    }
+    if(!c.current.empty()) submit(id, c);
+}
+
+void Server::on_readable(uint64_t id, Conn& c){
+    char buf[16384];
+    // A chunk at a time, so a connection over its caps stops being read.
+    while(!c.peer_closed && !throttled(c)){
+        ssize_t n = ::read(c.fd, buf, sizeof(buf));
+        if(n > 0){
+            c.in.append(buf, (size_t)n);
+            parse(id, c);
+            continue;
+        }
+        if(n < 0 && errno == EINTR) continue;
+        if(n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) c.peer_closed = true;
+        break;
+    }
+    consume(id, c);
+}
+
+void Server::pump(uint64_t id, Conn& c){
+    // Sending can lift the output cap and parsing held-back lines can queue
+    // more output, so go round until neither can move.
+    do{
+        if(c.paused && !throttled(c)) consume(id, c);
+        for(auto it = c.ready.find(c.send_seq); it != c.ready.end(); it = c.ready.find(c.send_seq)){
+            c.ready_bytes -= it->second.size();
+            c.out += it->second;
+            c.ready.erase(it);
+            ++c.send_seq;
+        }
+        while(c.out_pos < c.out.size()){
+            ssize_t w = ::send(c.fd, c.out.data() + c.out_pos, c.out.size() - c.out_pos, MSG_NOSIGNAL);
+            if(w > 0){
+                c.out_pos += (size_t)w;
+                continue;
+            }
+            if(w < 0 && errno == EINTR) continue;
+            if(w < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+            close_conn(id); // peer gone
+            return;
+        }
+        if(c.out_pos == c.out.size()){
+            c.out.clear();
+            c.out_pos = 0;
+        }
+    }while(c.paused && !throttled(c));
+    // Stop polling for input once the peer closed (it would stay readable)
+    // and while over a cap (level-triggered, so it fires again when re-armed).
+    const bool want_in = !c.peer_closed && !throttled(c);
+    const uint32_t events = (want_in ? uint32_t(EPOLLIN | EPOLLRDHUP) : 0u) |
+                            (c.out.empty() ? 0u : uint32_t(EPOLLOUT));
+    if(events != c.events){
+        epoll_event ev{};
+        ev.events = events;
+        ev.data.u64 = id;
+        ::epoll_ctl(ep_, EPOLL_CTL_MOD, c.fd, &ev);
+        c.events = events;
+    }
+    if(c.peer_closed && c.inflight == 0 && c.ready.empty() && c.out.empty()) close_conn(id);
+}
+
+void Server::close_conn(uint64_t id){
+    auto it = conns_.find(id);
+    if(it == conns_.end()) return;
+    ::epoll_ctl(ep_, EPOLL_CTL_DEL, it->second.fd, nullptr);
+    ::close(it->second.fd);
+    conns_.erase(it); // responses still in flight are dropped on arrival
+    if(!listening_){
+        if(spare_fd_ < 0) spare_fd_ = ::open("/dev/null", O_RDONLY | O_CLOEXEC);
+        set_listening(true);
+    }
+}
+
+void Server::drain_completions(){
+    uint64_t n;
+    ssize_t r = ::read(wake_fd_, &n, sizeof(n));
+    (void)r;
+    std::vector<Done> done;
+    {
+        std::lock_guard<std::mutex> lk(done_mu_);
+        done.swap(done_);
+    }
+    for(auto& d : done){
+        auto it = conns_.find(d.conn);
+        if(it == conns_.end()) continue;
+        --it->second.inflight;
+        add_ready(it->second, d.seq, std::move(d.response));
+    }
+    for(auto& d : done){
+        auto it = conns_.find(d.conn);
+        if(it != conns_.end()) pump(d.conn, it->second);
+    }
+}
+
+int Server::run(){
+    // SIGINT/SIGTERM arrive through a signalfd; every thread inherits the mask.
+    sigset_t mask;
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGINT);
+    sigaddset(&mask, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &mask, nullptr);
+    int sig_fd = ::signalfd(-1, &mask, SFD_NONBLOCK | SFD_CLOEXEC);
+
+    ep_ = ::epoll_create1(EPOLL_CLOEXEC);
+    wake_fd_ = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if(sig_fd < 0 || ep_ < 0 || wake_fd_ < 0){
+        std::cerr << "serve: setup failed: " << std::strerror(errno) << "\n";
+        return 1;
+    }
+    add(sig_fd, kSignal, EPOLLIN);
+    add(wake_fd_, kWake, EPOLLIN);
+    spare_fd_ = ::open("/dev/null", O_RDONLY | O_CLOEXEC);
+
+    if(!opt_.unix_path.empty()){
+        unix_fd_ = listen_unix(opt_.unix_path);
+        if(unix_fd_ < 0){
+            std::cerr << "serve: cannot listen on " << opt_.unix_path << ": " << std::strerror(errno) << "\n";
+            return 1;
+        }
+        add(unix_fd_, kUnixListener, EPOLLIN);
+    }
+    if(opt_.tcp_port > 0){
+        tcp_fd_ = listen_tcp(opt_.tcp_port);
+        if(tcp_fd_ < 0){
+            std::cerr << "serve: cannot listen on 127.0.0.1:" << opt_.tcp_port << ": " << std::strerror(errno) << "\n";
+            return 1;
+        }
+        add(tcp_fd_, kTcpListener, EPOLLIN);
+    }
+
+    int threads = opt_.threads;
+    if(threads <= 0) threads = (int)std::max(1u, std::thread::hardware_concurrency());
+    std::vector<std::thread> pool;
+    pool.reserve(threads);
+    for(int t = 0; t < threads; ++t) pool.emplace_back([this]{ worker(); });
+
+    std::cerr << "serve";
+    if(unix_fd_ >= 0) std::cerr << " unix=" << opt_.unix_path;
+    if(tcp_fd_ >= 0) std::cerr << " tcp=127.0.0.1:" << opt_.tcp_port;
+    std::cerr << " threads=" << threads << std::endl;
+
+    epoll_event evs[64];
+    bool stop = false;
+    while(!stop){
+        int n = ::epoll_wait(ep_, evs, 64, -1);
+        if(n < 0){
+            if(errno == EINTR) continue;
+            break;
+        }
+        for(int i = 0; i < n; ++i){
+            const uint64_t tag = evs[i].data.u64;
+            const uint32_t e = evs[i].events;
+            if(tag == kSignal){ stop = true; continue; }
+            if(tag == kWake){ drain_completions(); continue; }
+            if(tag == kUnixListener){ accept_all(unix_fd_, false); continue; }
+            if(tag == kTcpListener){ accept_all(tcp_fd_, true); continue; }
+            auto it = conns_.find(tag);
+            if(it == conns_.end()) continue;
+            if(e & EPOLLERR){ close_conn(tag); continue; }
+            // Hung up both ways: nothing can be sent back, and the hang-up
+            // would be reported again on every wait.
+            if(e & EPOLLHUP){ close_conn(tag); continue; }
+            if(!it->second.peer_closed && (e & (EPOLLIN | EPOLLRDHUP | EPOLLHUP))) on_readable(tag, it->second);
+            if(conns_.count(tag)) pump(tag, conns_[tag]);
+        }
+    }
+
+    jobs_.stop();
+    for(auto& th : pool) th.join();
+    for(auto& kv : conns_) ::close(kv.second.fd);
+    conns_.clear();
+    if(unix_fd_ >= 0){
+        ::close(unix_fd_);
+        ::unlink(opt_.unix_path.c_str());
+    }
+    if(tcp_fd_ >= 0) ::close(tcp_fd_);
+    if(spare_fd_ >= 0) ::close(spare_fd_);
+    ::close(wake_fd_);
+    ::close(ep_);
+    ::close(sig_fd);
+    std::cerr << "serve stopped requests=" << requests_ << " puzzles=" << puzzles_
+              << " shed=" << shed_ << "\n";
+    return 0;
+}
+} // namespace
+
+int run_server(const SolverConfig& cfg, const ServeOptions& opt){
+    Server server(cfg, opt);
+    return server.run();
+}
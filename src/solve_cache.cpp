@@ -0,0 +1,214 @@
+#include "solve_cache.hpp"
+#include <algorithm>
+#include <cstring>
+#include <string_view>
+
+namespace {
+// Lines (rows or columns) grouped in threes (bands or stacks), in the order
+// a candidate reads them: outer[i] is the i-th group, inner[g] the lines of
+// group g.
+struct LineOrder {
+    uint8_t outer[3];
+    uint8_t inner[3][3];
+};
+
+// A run of equally ranked entries whose permutations must all be tried.
+struct TieRun {
+    uint8_t* first;
+    int len;
+};
+
+uint64_t factorial(int n){
+    uint64_t f = 1;
+    for(int i = 2; i <= n; ++i) f *= (uint64_t)i;
+    return f;
+}
+
+// Sort a[0..n) by rank (index breaks ties, so every run starts ascending as
+// next_permutation expects) and record runs of equal rank.
+void rank_sort(uint8_t* a, int n, const uint32_t* rank, std::vector<TieRun>& ties, uint64_t& perms){
+    std::sort(a, a + n, [&](uint8_t x, uint8_t y){
+        return rank[x] != rank[y] ? rank[x] < rank[y] : x < y;
+    });
+    for(int i = 0; i < n;){
+        int j = i + 1;
+        while(j < n && rank[a[j]] == rank[a[i]]) ++j;
+        if(j - i > 1){
+            ties.push_back(TieRun{a + i, j - i});
+            perms *= factorial(j - i);
+        }
+        i = j;
+    }
+}
+
+// line_rank: invariant of each line; groups are ranked by their lines' sum.
+void order_lines(const uint32_t* line_rank, LineOrder& o, std::vector<TieRun>& ties, uint64_t& perms){
+    uint32_t group_rank[3];
+    for(int g = 0; g < 3; ++g){
+        group_rank[g] = line_rank[g * 3] + line_rank[g * 3 + 1] + line_rank[g * 3 + 2];
+        o.outer[g] = (uint8_t)g;
+        for(int k = 0; k < 3; ++k) o.inner[g][k] = (uint8_t)(g * 3 + k);
+    }
+    rank_sort(o.outer, 3, group_rank, ties, perms);
+    for(int g = 0; g < 3; ++g) rank_sort(o.inner[g], 3, line_rank, ties, perms);
+}
+
+void flatten(const LineOrder& o, uint8_t* lines){
+    for(int i = 0; i < 3; ++i)
+        for(int k = 0; k < 3; ++k) lines[i * 3 + k] = o.inner[o.outer[i]][k];
+}
+} // namespace
+
+void canonicalize(const Grid81& puzzle, CanonicalForm& out){
+    bool have_best = false;
+    Grid81 g, cand;
+    std::vector<TieRun> ties;
+    ties.reserve(16);
+
+    for(int t = 0; t < 2; ++t){
+        for(int r = 0; r < 9; ++r)
+            for(int c = 0; c < 9; ++c) g[r * 9 + c] = t ? puzzle[c * 9 + r] : puzzle[r * 9 + c];
+
+        // Rank a line by its clue count, then by the clue counts of the lines
+        // crossing it at its clues (both unchanged by any line permutation).
+        uint32_t row_count[9] = {}, col_count[9] = {};
+        for(int i = 0; i < 81; ++i){
+            if(!g[i]) continue;
+            ++row_count[i / 9];
+            ++col_count[i % 9];
+        }
+        uint32_t row_rank[9], col_rank[9];
+        for(int k = 0; k < 9; ++k){
+            row_rank[k] = row_count[k] << 7;
+            col_rank[k] = col_count[k] << 7;
+        }
+        for(int i = 0; i < 81; ++i){
+            if(!g[i]) continue;
+            row_rank[i / 9] += col_count[i % 9];
+            col_rank[i % 9] += row_count[i / 9];
+        }
+
+        LineOrder rows, cols;
+        ties.clear();
+        uint64_t perms = 1;
+        order_lines(row_rank, rows, ties, perms);
+        order_lines(col_rank, cols, ties, perms);
+        if(perms > (uint64_t)kMaxCanonicalCandidates) ties.clear();
+
+        // Odometer over the tie runs; each candidate is compared against the
+        // best grid while it is built and dropped at the first larger cell.
+        do{
+            uint8_t R[9], C[9];
+            flatten(rows, R);
+            flatten(cols, C);
+            uint8_t relabel[10] = {};
+            uint8_t next = 1;
+            bool smaller = !have_best;
+            bool larger = false;
+            for(int i = 0; i < 81; ++i){
+                uint8_t v = g[R[i / 9] * 9 + C[i % 9]];
+                if(v){
+                    if(!relabel[v]) relabel[v] = next++;
+                    v = relabel[v];
+                }
+                if(!smaller){
+                    if(v > out.grid[i]){ larger = true; break; }
+                    if(v < out.grid[i]) smaller = true;
+                }
+                cand[i] = v;
+            }
+            if(larger || !smaller) continue;
+            have_best = true;
+            out.grid = cand;
+            out.transpose = t != 0;
+            std::memcpy(out.row, R, 9);
+            std::memcpy(out.col, C, 9);
+            // Digits absent from the puzzle take the remaining labels in order.
+            for(int d = 1; d <= 9; ++d) if(!relabel[d]) relabel[d] = next++;
+            std::memcpy(out.relabel, relabel, sizeof(relabel));
+        }while([&]{
+            for(TieRun& run : ties)
+                if(std::next_permutation(run.first, run.first + run.len)) return true;
+            return false;
+        }());
+    }
+}
+
+void CanonicalForm::to_original(const uint8_t* canon, uint8_t* out) const{
+    uint8_t inverse[10] = {};
+    for(int d = 1; d <= 9; ++d) inverse[relabel[d]] = (uint8_t)d;
+    for(int r = 0; r < 9; ++r){
+        for(int c = 0; c < 9; ++c){
+            int x = row[r], y = col[c];
+            out[transpose ? y * 9 + x : x * 9 + y] = inverse[canon[r * 9 + c]];
+        }
+    }
+}
+
+void CanonicalForm::to_canonical(const uint8_t* orig, uint8_t* out) const{
+    for(int r = 0; r < 9; ++r){
+        for(int c = 0; c < 9; ++c){
+            int x = row[r], y = col[c];
+            out[r * 9 + c] = relabel[orig[transpose ? y * 9 + x : x * 9 + y]];
+        }
+    }
+}
+
+size_t SolveCache::KeyHash::operator()(const Grid81& g) const{
+    return std::hash<std::string_view>()(
+        std::string_view(reinterpret_cast<const char*>(g.data()), g.size()));
+}
+
+SolveCache::SolveCache(size_t capacity) : capacity_(std::max<size_t>(1, capacity)){
+    nodes_.reserve(std::min<size_t>(capacity_, 1 << 16));
+    map_.reserve(std::min<size_t>(capacity_, 1 << 16));
+}
+
+void SolveCache::unlink(uint32_t i){
+    Node& n = nodes_[i];
+    if(n.prev != kNone) nodes_[n.prev].next = n.next; else head_ = n.next;
+    if(n.next != kNone) nodes_[n.next].prev = n.prev; else tail_ = n.prev;
+    n.prev = n.next = kNone;
+}
+
+void SolveCache::push_front(uint32_t i){
+    Node& n = nodes_[i];
+    n.prev = kNone;
+    n.next = head_;
+    if(head_ != kNone) nodes_[head_].prev = i;
+    head_ = i;
+    if(tail_ == kNone) tail_ = i;
+}
+
+const SolveCache::Entry* SolveCache::find(const Grid81& key){
+    auto it = map_.find(key);
+    if(it == map_.end()){
+        ++stats_.misses;
+        return nullptr;
+    }
+    ++stats_.hits;
+    if(head_ != it->second){
+        unlink(it->second);
+        push_front(it->second);
+    }
+    return &nodes_[it->second].entry;
+}
+
+void SolveCache::insert(const Grid81& key, bool solved, const uint8_t* solution){
+    uint32_t i;
+    if(nodes_.size() < capacity_){
+        i = (uint32_t)nodes_.size();
+        nodes_.emplace_back();
+    }else{
+        i = tail_;
+        unlink(i);
+        map_.erase(nodes_[i].key);
+        ++stats_.evictions;
+    }
+    Node& n = nodes_[i];
+    n.key = key;
+    n.entry.solved = solved;
+    if(solved) std::memcpy(n.entry.solution.data(), solution, 81);
+    map_.emplace(key, i);
+    push_front(i);
+}
@@ -2,25 +2,30 @@
 #include "geometry.hpp"
 #include "propagation.hpp"
 #include "dfs.hpp"
-#include <sstream>
-#include <chrono>
-#include <sys/resource.h>
+#include "parallel_search.hpp"
+#include "portfolio.hpp"
+#include "timing.hpp"
+#include "packed.hpp"
+#include <algorithm>
 
 namespace {
-using SteadyClock = std::chrono::steady_clock;
-inline double cpu_time_seconds(){
-    rusage ru{};
-    getrusage(RUSAGE_SELF, &ru);
-    double user = ru.ru_utime.tv_sec + ru.ru_utime.tv_usec * 1e-6;
-    double sys  = ru.ru_stime.tv_sec + ru.ru_stime.tv_usec * 1e-6;
-    return user + sys;
+// Start of one SolverTimings phase. Clocks are only read when timings were
+// requested, so an untimed solve makes no clock calls at all.
+struct PhaseClock {
+    uint64_t ticks = 0;
+    uint64_t cpu_ns = 0;
+};
+inline PhaseClock phase_start(const SolverTimings* t){
+    if(!t) return PhaseClock{};
+    timing::ns_per_tick(); // calibrate outside the measured phase
+    return PhaseClock{timing::ticks(), timing::thread_cpu_ns()};
 }
-inline double wall_ms(SteadyClock::time_point start, SteadyClock::time_point end){
-    return std::chrono::duration<double, std::milli>(end - start).count();
+inline void phase_end(const PhaseClock& start, double& wall_ms, double& cpu_ms){
+    wall_ms = timing::ticks_to_ms(timing::ticks() - start.ticks);
+    cpu_ms = timing::ns_to_ms(timing::thread_cpu_ns() - start.cpu_ns);
 }
-<<<<<<< HEAD
 
-bool validate_solution(const SolverState& S, const std::string& puzzle){
+bool validate_solution(const SolverState& S, std::string_view puzzle){
     // Check all cells filled and fixed clues honored.
     for(int i = 0; i < 81; ++i){
         int v = S.cell_value[i];
@@ -74,81 +79,242 @@ bool validate_solution(const SolverState& S, const std::string& puzzle){
 
     return true;
 }
-=======
->>>>>>> origin/main
+
+// The shared-table constructor builds no table of its own.
+SolverConfig without_tt(SolverConfig cfg){
+    cfg.tt_mb = 0;
+    return cfg;
+}
 } // namespace
 
 SudokuSolver::SudokuSolver(const SolverConfig& cfg) : config_(cfg) {
-    static bool geom_inited = false;
-    if(!geom_inited){
-        geom::init();
-        geom_inited = true;
-    }
     S_.trail = &trail_;
+    S_.boards = config_.boards;
+    S_.inference = config_.inference.any() ? &config_.inference : nullptr;
+    S_.wdeg = config_.branching == Branching::Wdeg;
+    S_.wdeg_decay = config_.wdeg_decay;
     trail_.reserve(1<<16);
+    size_snapshots();
+    if(config_.cache_entries) cache_ = std::make_unique<SolveCache>(config_.cache_entries);
+    if(config_.tt_mb) tt_ = std::make_shared<TranspositionTable>(config_.tt_mb);
+    S_.tt = tt_.get();
+}
+
+SudokuSolver::SudokuSolver(const SolverConfig& cfg, std::shared_ptr<TranspositionTable> tt)
+    : SudokuSolver(without_tt(cfg)) {
+    config_.tt_mb = tt ? tt->mb() : 0;
+    tt_ = std::move(tt);
+    S_.tt = tt_.get();
+}
+
+void SudokuSolver::set_config(const SolverConfig& cfg){
+    config_ = cfg;
+    S_.boards = cfg.boards;
+    S_.inference = config_.inference.any() ? &config_.inference : nullptr;
+    S_.wdeg = config_.branching == Branching::Wdeg;
+    S_.wdeg_decay = config_.wdeg_decay;
+    size_snapshots();
+    // Entries stay valid across configs (solutions are solutions); only the
+    // capacity matters.
+    if(!cfg.cache_entries) cache_.reset();
+    else if(!cache_ || cache_->capacity() != cfg.cache_entries) cache_ = std::make_unique<SolveCache>(cfg.cache_entries);
+    // Dead states stay dead under any config, too.
+    if(!cfg.tt_mb) tt_.reset();
+    else if(!tt_ || tt_->mb() != cfg.tt_mb) tt_ = std::make_shared<TranspositionTable>(cfg.tt_mb);
+    S_.tt = tt_.get();
+}
+
+void SudokuSolver::size_snapshots(){
+    // One slot per DFS depth: every level fixes at least one cell, plus the
+    // extra py level of the dual search.
+    size_t levels = 0;
+    if(config_.restore == RestoreMode::Snapshot) levels = 83;
+    else if(config_.restore == RestoreMode::Hybrid) levels = (size_t)std::max(0, std::min(config_.snapshot_depth, 83));
+    trail_.snapshots.resize(levels);
+}
+
+void SudokuSolver::arm_limits(){
+    const SolveLimits& lim = config_.limits;
+    uint64_t deadline = 0;
+    if(lim.max_us){
+        deadline = timing::ticks() + (uint64_t)((double)lim.max_us * 1000.0 / timing::ns_per_tick());
+    }
+    S_.node_limit = lim.max_nodes;
+    S_.trail_limit = lim.max_trail;
+    S_.deadline = deadline;
+    band_.set_limits(lim.max_nodes, deadline);
+}
+
+void SudokuSolver::finish_stats(){
+    S_.stats.nodes = S_.nodes;
+    if constexpr(cfg::kStats) S_.stats.trail_peak = std::max<uint64_t>(S_.stats.trail_peak, trail_.mark());
+}
+
+bool SudokuSolver::solve(std::string_view puzzle, SolverTimings* timings){
+    return cache_ ? solve_cached(puzzle, nullptr, timings) : solve_impl(puzzle, nullptr, timings);
+}
+
+bool SudokuSolver::solve_packed(const uint8_t* rec, SolverTimings* timings){
+    // The text form is only needed by the band engine and the clue check.
+    char text[81];
+    packed::unpack_grid(rec, text);
+    std::string_view view(text, 81);
+    return cache_ ? solve_cached(view, rec, timings) : solve_impl(view, rec, timings);
+}
+
+bool SudokuSolver::solve_cached(std::string_view puzzle, const uint8_t* rec, SolverTimings* timings){
+    Grid81 grid{};
+    for(int i = 0; i < 81; ++i){
+        if(rec) grid[i] = (uint8_t)packed::cell(rec, i);
+        else if(i < (int)puzzle.size() && puzzle[i] >= '1' && puzzle[i] <= '9') grid[i] = (uint8_t)(puzzle[i] - '0');
+        if(grid[i] > 9) grid[i] = 0;
+    }
+    CanonicalForm canon;
+    canonicalize(grid, canon);
+    if(const SolveCache::Entry* e = cache_->find(canon.grid)){
+        // No search ran: report an empty one.
+        result_ = e->solved ? SolveResult::Solved : SolveResult::Unsolved;
+        S_.nodes = 0;
+        S_.stats = SolverStats{};
+        S_.inference_stats = InferenceStats{};
+        S_.tt_stats = TTStats{};
+        if(timings) *timings = SolverTimings{};
+        if(!e->solved) return false;
+        canon.to_original(e->solution.data(), S_.cell_value.data());
+        return true;
+    }
+    bool ok = solve_impl(puzzle, rec, timings);
+    if(result_ == SolveResult::Timeout) return false; // says nothing about the puzzle
+    Grid81 solution{};
+    if(ok) canon.to_canonical(S_.cell_value.data(), solution.data());
+    cache_->insert(canon.grid, ok, solution.data());
+    return ok;
 }
 
-bool SudokuSolver::solve(const std::string& puzzle, SolverTimings* timings){
-<<<<<<< HEAD
+bool SudokuSolver::solve_impl(std::string_view puzzle, const uint8_t* rec, SolverTimings* timings){
     // Important: this solver instance can be reused across many puzzles (benchmark mode).
     // The trail must be cleared per puzzle; otherwise memory grows without bound.
     trail_.log.clear();
+    arm_limits();
+    portfolio_stats_ = PortfolioStats{};
+
+    if(config_.engine == Engine::Band){
+        // The band engine propagates inside its search; report it all as search.
+        PhaseClock clk = phase_start(timings);
+        S_.cell_value.fill(0);
+        bool ok = band_.solve(puzzle, S_.cell_value.data());
+        ok = ok && validate_solution(S_, puzzle);
+        result_ = ok ? SolveResult::Solved : band_.aborted() ? SolveResult::Timeout : SolveResult::Unsolved;
+        S_.nodes = band_.nodes();
+        S_.stats = SolverStats{};
+        S_.stats.nodes = S_.nodes;
+        if(timings){
+            *timings = SolverTimings{};
+            phase_end(clk, timings->search_wall_ms, timings->search_cpu_ms);
+        }
+        return ok;
+    }
 
-=======
->>>>>>> origin/main
-    auto init_wall_start = SteadyClock::now();
-    double init_cpu_start = cpu_time_seconds();
-    S_.init_from_puzzle(puzzle);
-    auto init_wall_end = SteadyClock::now();
-    double init_cpu_end = cpu_time_seconds();
+    PhaseClock clk = phase_start(timings);
+    if(rec) S_.init_from_packed(rec);
+    else S_.init_from_puzzle(puzzle);
     if(timings){
-        timings->init_wall_ms = wall_ms(init_wall_start, init_wall_end);
-        timings->init_cpu_ms = (init_cpu_end - init_cpu_start) * 1000.0;
+        phase_end(clk, timings->init_wall_ms, timings->init_cpu_ms);
+        clk = phase_start(timings);
     }
 
     // Initial propagation: for any pre-fixed cells, queues were primed
-    auto prop_wall_start = SteadyClock::now();
-    double prop_cpu_start = cpu_time_seconds();
     bool ok = propagate(S_);
-    auto prop_wall_end = SteadyClock::now();
-    double prop_cpu_end = cpu_time_seconds();
     if(timings){
-        timings->propagate_wall_ms = wall_ms(prop_wall_start, prop_wall_end);
-        timings->propagate_cpu_ms = (prop_cpu_end - prop_cpu_start) * 1000.0;
+        phase_end(clk, timings->propagate_wall_ms, timings->propagate_cpu_ms);
+        clk = phase_start(timings);
+    }
+    if(!ok){
+        finish_stats();
+        result_ = SolveResult::Unsolved;
+        return false;
     }
-    if(!ok) return false;
 
-    auto search_wall_start = SteadyClock::now();
-    double search_cpu_start = cpu_time_seconds();
-    if(config_.dual.enabled){
+    if(config_.portfolio && !S_.is_solved()){
+        int winner = -1;
+        ok = portfolio_dfs(S_, config_, winner);
+        portfolio_stats_.races = 1;
+        if(winner >= 0) ++portfolio_stats_.wins[winner];
+    }else if(config_.dual.enabled){
         ok = dfs_dual(S_, config_);
+    }else if(config_.parallel.threads != 1){
+        // Easy puzzles finish inside the budget; past it the sequential
+        // search has rolled back to the root and the tree is split.
+        const uint64_t max_nodes = config_.limits.max_nodes;
+        const uint64_t budget = config_.parallel.node_budget;
+        S_.node_limit = max_nodes && max_nodes < budget ? max_nodes : budget;
+        ok = dfs_single(S_, config_);
+        S_.node_limit = max_nodes;
+        // Split only if the budget (not one of the limits) stopped it.
+        if(S_.aborted && S_.nodes > budget && (!max_nodes || S_.nodes <= max_nodes)){
+            S_.aborted = false;
+            ok = parallel_dfs(S_, config_);
+        }
     }else{
         ok = dfs_single(S_, config_);
     }
-    auto search_wall_end = SteadyClock::now();
-    double search_cpu_end = cpu_time_seconds();
-    if(timings){
-        timings->search_wall_ms = wall_ms(search_wall_start, search_wall_end);
-        timings->search_cpu_ms = (search_cpu_end - search_cpu_start) * 1000.0;
+    if(timings) phase_end(clk, timings->search_wall_ms, timings->search_cpu_ms);
+    finish_stats();
+
+    if(ok && !validate_solution(S_, puzzle)) ok = false;
+    result_ = ok ? SolveResult::Solved : S_.aborted ? SolveResult::Timeout : SolveResult::Unsolved;
+    return ok;
+}
+
+int SudokuSolver::count_solutions(std::string_view puzzle, int limit){
+    return count_impl(puzzle, nullptr, limit);
+}
+
+int SudokuSolver::count_solutions_packed(const uint8_t* rec, int limit){
+    char text[81];
+    packed::unpack_grid(rec, text);
+    return count_impl(std::string_view(text, 81), rec, limit);
+}
+
+int SudokuSolver::count_impl(std::string_view puzzle, const uint8_t* rec, int limit){
+    trail_.log.clear();
+    arm_limits();
+    if(config_.engine == Engine::Band){
+        S_.cell_value.fill(0);
+        int n = band_.count(puzzle, limit, S_.cell_value.data());
+        S_.nodes = band_.nodes();
+        S_.stats = SolverStats{};
+        S_.stats.nodes = S_.nodes;
+        result_ = band_.aborted() ? SolveResult::Timeout : n > 0 ? SolveResult::Solved : SolveResult::Unsolved;
+        return n;
     }
+    if(rec) S_.init_from_packed(rec);
+    else S_.init_from_puzzle(puzzle);
+    int n = propagate(S_) ? dfs_count(S_, config_, limit) : 0;
+    finish_stats();
+    result_ = S_.aborted ? SolveResult::Timeout : n > 0 ? SolveResult::Solved : SolveResult::Unsolved;
+    return n;
+}
 
-<<<<<<< HEAD
-    if(ok && !validate_solution(S_, puzzle)) return false;
-=======
->>>>>>> origin/main
+bool SudokuSolver::fill_random(uint64_t seed){
+    trail_.log.clear();
+    arm_limits();
+    S_.init_from_puzzle("");
+    S_.rng = seed ? seed : 0x9E3779B97F4A7C15ull;
+    bool ok = dfs_single(S_, config_);
+    S_.rng = 0;
+    finish_stats();
+    result_ = ok ? SolveResult::Solved : S_.aborted ? SolveResult::Timeout : SolveResult::Unsolved;
     return ok;
 }
 
 std::string SudokuSolver::solution_string() const{
-    std::ostringstream oss;
-    for(int i=0;i<81;++i){
-        int v = S_.cell_value[i];
-        if(v==0){
-            // produce a best-effort candidate (optional)
-            oss << '0';
-        }else{
-            oss << char('0' + v);
-        }
-    }
-    return oss.str();
+    std::string out(81, '0');
+    solution_into(out.data());
+    return out;
+}
+
+void SudokuSolver::solution_into(char* out) const{
+    // cell_value is 0 for unfilled cells, which maps to '0' as well.
+    for(int i=0;i<81;++i) out[i] = char('0' + S_.cell_value[i]);
 }
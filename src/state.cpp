@@ -1,6 +1,8 @@
 #include "state.hpp"
 #include "trail.hpp"
 #include "geometry.hpp"
+#include "board_simd.hpp"
+#include "packed.hpp"
 #include <cassert>
 #include <cstring>
 #include <algorithm>
@@ -8,6 +10,11 @@
 void SolverState::reset(){
     std::fill(cell_mask.begin(), cell_mask.end(), 0);
     std::fill(cell_value.begin(), cell_value.end(), 0);
+    open = geom::bnot(geom::Bits81{}); // all 81 cells empty
+    mrv_bucket.fill(geom::Bits81{});
+    nodes = 0;
+    stats = SolverStats{};
+    inference_stats = InferenceStats{};
     for(int d=0; d<9; ++d){ B[d] = geom::Bits81{}; }
     for(int u=0; u<27; ++u) for(int d=0; d<9; ++d) unit_digit_count[u][d]=0;
     q_l4.clear(); q_l1.clear(); q_lock.clear();
@@ -18,14 +25,18 @@ void SolverState::reset(){
     contradiction = false;
     scarcity.fill(0);
     last_prop_placements = 0;
+    aborted = false;
+    unit_weight.fill(0.0f);
+    hash = 0;
+    tt_stats = TTStats{};
+    wdeg_bump = 1.0f;
 }
 
 bool SolverState::is_solved() const{
-    for(int i=0;i<81;++i) if(!cell_value[i]) return false;
-    return true;
+    return !geom::any(open);
 }
 
-void SolverState::init_from_puzzle(const std::string& puzzle){
+void SolverState::init_from_puzzle(std::string_view puzzle){
     reset();
     // Initialize base candidates
     for(int i=0;i<81;++i){
@@ -43,6 +54,22 @@ void SolverState::init_from_puzzle(const std::string& puzzle){
             cell_mask[i] = 0x1FFu;
             cell_value[i] = 0;
         }
+    }
+    init_from_masks();
+}
+
+void SolverState::init_from_packed(const uint8_t* rec){
+    reset();
+    for(int i=0;i<81;++i){
+        int v = packed::cell(rec, i);
+        cell_mask[i] = (v>=1 && v<=9) ? (uint16_t)(1u<<(v-1)) : (uint16_t)0x1FFu;
+    }
+    init_from_masks();
+}
+
+void SolverState::init_from_masks(){
+    for(int i=0;i<81;++i){
+        geom::set_bit(mrv_bucket[popcount9(cell_mask[i])], i);
         // Fill B[] from mask (as initial candidate set; placed cells will be fixed below)
         for(int d=0; d<9; ++d){
             if( (cell_mask[i] >> d) & 1u ){
@@ -52,7 +79,9 @@ void SolverState::init_from_puzzle(const std::string& puzzle){
         }
     }
     // Initialize unit counters from B (popcount of B[d] intersect unit)
-    for(int u=0; u<27; ++u){
+    if(boards == BoardBackend::Simd){
+        simd::unit_counts(B, unit_digit_count);
+    }else for(int u=0; u<27; ++u){
         auto um = geom::UNIT_MASK[u];
         for(int d=0; d<9; ++d){
             auto im = geom::band(B[d], um);
@@ -64,7 +93,6 @@ void SolverState::init_from_puzzle(const std::string& puzzle){
         scarcity[d] = geom::popcnt(B[d]);
     }
     // Enqueue L4 for any singletons (givens or forced)
-<<<<<<< HEAD
     // Seed with dedup flags so later enqueues don't create duplicates.
     for(int i=0;i<81;++i){
         if (__builtin_popcount((unsigned)cell_mask[i]) == 1) {
@@ -72,11 +100,6 @@ void SolverState::init_from_puzzle(const std::string& puzzle){
                 q_l4.push_back(i);
                 enq_l4[i] = 1;
             }
-=======
-    for(int i=0;i<81;++i){
-        if (__builtin_popcount((unsigned)cell_mask[i]) == 1) {
-            q_l4.push_back(i);
->>>>>>> origin/main
         }
     }
 }
@@ -0,0 +1,100 @@
+#include "stream.hpp"
+#include "solver.hpp"
+#include "output_buffer.hpp"
+#include "puzzle_reader.hpp"
+#include "timing.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <poll.h>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+constexpr size_t kReadChunk = 64 * 1024;
+} // namespace
+
+StreamResult run_stream(const SolverConfig& cfg, const StreamOptions& opt){
+    SudokuSolver solver(cfg);
+    OutputBuffer out(opt.out_fd);
+    StreamResult res;
+
+    std::vector<char> buf(std::max(kReadChunk, opt.max_line + 1));
+    size_t begin = 0, end = 0;      // unconsumed input is buf[begin, end)
+    bool skipping = false;          // dropping the rest of an over-long line
+    size_t pending = 0;             // answers in `out` not yet written
+    uint64_t oldest_ns = 0;         // when the first of them was produced
+    const uint64_t flush_ns = (uint64_t)(opt.flush_ms > 0 ? opt.flush_ms : 0) * 1000000ull;
+
+    auto flush = [&]{
+        if(!out.flush()) res.io_ok = false;
+        pending = 0;
+    };
+    auto answer = [&](std::string_view line){
+        std::string_view p = trim_view(line);
+        if(p.empty() || p.front() == '#') return;
+        ++res.puzzles;
+        if(line.size() > opt.max_line){
+            out.append(kLineTooLongText);
+        }else if(opt.count_limit > 0){
+            int cnt = solver.count_solutions(p, opt.count_limit);
+            const bool timeout = solver.result() == SolveResult::Timeout;
+            if(cnt == 1 && !timeout) ++res.solved;
+            if(timeout) out.append(kTimeoutText);
+            else append_count(out, cnt, opt.count_limit);
+        }else if(solver.solve(p)){
+            ++res.solved;
+            solver.solution_into(out.reserve(81));
+            out.commit(81);
+        }else{
+            out.append(solver.result() == SolveResult::Timeout ? kTimeoutText : kUnsolvedText);
+        }
+        out.put('\n');
+        if(pending++ == 0) oldest_ns = timing::mono_ns();
+        if(pending >= opt.batch || timing::mono_ns() - oldest_ns >= flush_ns) flush();
+    };
+
+    bool eof = false;
+    while(!eof){
+        // Answer every complete line already buffered.
+        while(const void* nl = std::memchr(buf.data() + begin, '\n', end - begin)){
+            size_t stop = (size_t)(static_cast<const char*>(nl) - buf.data());
+            if(!skipping) answer(std::string_view(buf.data() + begin, stop - begin));
+            skipping = false;
+            begin = stop + 1;
+        }
+        // Keep the partial line at the front. One longer than max_line is
+        // answered now and the rest of it dropped as it arrives.
+        if(skipping) begin = end;
+        if(!skipping && end - begin > opt.max_line){
+            answer(std::string_view(buf.data() + begin, end - begin));
+            skipping = true;
+            begin = end;
+        }
+        if(begin > 0){
+            std::memmove(buf.data(), buf.data() + begin, end - begin);
+            end -= begin;
+            begin = 0;
+        }
+
+        // Nothing more waiting: the caller may be blocked on these answers.
+        if(pending){
+            pollfd pfd{opt.in_fd, POLLIN, 0};
+            int r = ::poll(&pfd, 1, 0);
+            if(r < 0 && errno == EINTR) continue;
+            if(r == 0) flush();
+        }
+
+        ssize_t n = ::read(opt.in_fd, buf.data() + end, buf.size() - end);
+        if(n < 0){
+            if(errno == EINTR) continue;
+            res.io_ok = false;
+            break;
+        }
+        if(n == 0) eof = true;
+        end += (size_t)n;
+    }
+    if(end > begin && !skipping) answer(std::string_view(buf.data() + begin, end - begin)); // unterminated last line
+    flush();
+    return res;
+}
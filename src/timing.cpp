@@ -0,0 +1,46 @@
+#include "timing.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace timing {
+
+double ns_per_tick(){
+    static const double ratio = []{
+#ifdef CPPSOLVER_HAVE_TSC
+        const uint64_t n0 = mono_ns(), t0 = ticks();
+        uint64_t n1 = n0;
+        while(n1 - n0 < 2000000) n1 = mono_ns();
+        const uint64_t t1 = ticks();
+        return t1 > t0 ? (double)(n1 - n0) / (double)(t1 - t0) : 1.0;
+#else
+        return 1.0;
+#endif
+    }();
+    return ratio;
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& o){
+    samples_.insert(samples_.end(), o.samples_.begin(), o.samples_.end());
+    sorted_ = sorted_ && o.samples_.empty();
+    for(size_t k = 0; k < buckets_.size(); ++k) buckets_[k] += o.buckets_[k];
+}
+
+void LatencyHistogram::sort(){
+    if(!sorted_) std::sort(samples_.begin(), samples_.end());
+    sorted_ = true;
+}
+
+uint64_t LatencyHistogram::percentile(double p){
+    if(samples_.empty()) return 0;
+    sort();
+    size_t rank = (size_t)std::ceil(std::clamp(p, 0.0, 100.0) / 100.0 * (double)samples_.size());
+    return samples_[rank ? rank - 1 : 0];
+}
+
+uint64_t LatencyHistogram::max(){
+    if(samples_.empty()) return 0;
+    sort();
+    return samples_.back();
+}
+
+} // namespace timing
@@ -2,25 +2,34 @@
 #include "state.hpp"
 #include "geometry.hpp"
 #include <cassert>
+#include <cstring>
+
+// Any queues/enqueue flags left over belong to the abandoned branch.
+// A flag is set exactly while its event sits in a queue (enqueue sets both,
+// pop clears the flag), so clearing the flags of the pending entries is enough
+// and the cost follows what the branch left behind, not the flag array sizes.
+static void drop_pending_events(SolverState& S){
+    for(int c : S.q_l4) S.enq_l4[c] = 0;
+    for(int t : S.q_l1) S.enq_l1[(t>>4)*9 + (t&15)] = 0;
+    for(int t : S.q_lock) S.enq_lock[(t>>4)*9 + (t&15)] = 0;
+    S.q_l4.clear();
+    S.q_l1.clear();
+    S.q_lock.clear();
+}
 
 void Trail::undo_to(SolverState& S, size_t to_index){
     while(log.size() > to_index){
-<<<<<<< HEAD
         TrailEntry e = log.back(); 
         log.pop_back();
 
         int c = e.cell;
-=======
-        auto e = log.back(); log.pop_back();
-        int c = e.cell, d = e.digit;
->>>>>>> origin/main
         uint16_t oldm = e.old_mask;
         uint16_t curm = S.cell_mask[c];
 
-        // Restore mask first
+        // Restore mask first (an open cell also moves back to its old MRV bucket)
         S.cell_mask[c] = oldm;
+        if(e.type == TrailType::ELIM && !S.cell_value[c]) mrv_move(S, c, curm, oldm);
 
-<<<<<<< HEAD
         const auto& U = geom::CELL_UNITS[c];
 
         if(e.type == TrailType::ELIM){
@@ -56,35 +65,37 @@ void Trail::undo_to(SolverState& S, size_t to_index){
                 if(c<64) S.B[x].lo &= ~(1ULL<<c); else S.B[x].hi &= ~(1ULL<<(c-64));
                 for(int ui=0; ui<3; ++ui) --S.unit_digit_count[U[ui]][x];
             }
-=======
-        // Adjust B[d] bit for this cell using old/new mask relationship
-        auto had_d_before = (oldm >> d) & 1u;
-        auto has_d_now    = (curm >> d) & 1u; // before undo
-        if(had_d_before && !has_d_now){
-            // We had removed d at (c), restore it
-            if(c<64) S.B[d].lo |= (1ULL<<c); else S.B[d].hi |= (1ULL<<(c-64));
-            // Increment unit counts for the 3 units of c
-            const auto& U = geom::CELL_UNITS[c];
-            for(int ui=0; ui<3; ++ui) ++S.unit_digit_count[U[ui]][d];
-        } else if(!had_d_before && has_d_now){
-            // In rare cases, a PLACE removed d from c; old mask did not have d (should be rare)
-            if(c<64) S.B[d].lo &= ~(1ULL<<c); else S.B[d].hi &= ~(1ULL<<(c-64));
-            const auto& U = geom::CELL_UNITS[c];
-            for(int ui=0; ui<3; ++ui) --S.unit_digit_count[U[ui]][d];
-        }
-
-        // Restore cell_value if needed
-        if(e.type == TrailType::PLACE){
->>>>>>> origin/main
             S.cell_value[c] = 0;
+            S.hash ^= zobrist::key(c, e.digit);
+            geom::set_bit(S.open, c);
+            geom::set_bit(S.mrv_bucket[popcount9(oldm)], c);
         }
     }
     S.contradiction = false;
-    // Any queues/enqueue flags left over belong to the abandoned branch.
-    S.q_l4.clear();
-    S.q_l1.clear();
-    S.q_lock.clear();
-    S.enq_l4.fill(0);
-    S.enq_l1.fill(0);
-    S.enq_lock.fill(0);
+    drop_pending_events(S);
+}
+
+void Trail::save_snapshot(const SolverState& S, int level){
+    StateSnapshot& s = snapshots[level];
+    s.B = S.B;
+    s.mrv_bucket = S.mrv_bucket;
+    s.open = S.open;
+    std::memcpy(s.unit_digit_count, S.unit_digit_count, sizeof(s.unit_digit_count));
+    s.cell_mask = S.cell_mask;
+    s.cell_value = S.cell_value;
+    s.hash = S.hash;
+}
+
+void Trail::restore_snapshot(SolverState& S, int level, size_t to_index){
+    const StateSnapshot& s = snapshots[level];
+    S.B = s.B;
+    S.mrv_bucket = s.mrv_bucket;
+    S.open = s.open;
+    std::memcpy(S.unit_digit_count, s.unit_digit_count, sizeof(s.unit_digit_count));
+    S.cell_mask = s.cell_mask;
+    S.cell_value = s.cell_value;
+    S.hash = s.hash;
+    log.resize(to_index);
+    S.contradiction = false;
+    drop_pending_events(S);
 }
@@ -0,0 +1,11 @@
+#include "transposition.hpp"
+#include <algorithm>
+
+TranspositionTable::TranspositionTable(size_t mb) : mb_(mb){
+    // Largest power of two number of buckets that fits in `mb` MiB.
+    const size_t bucket_bytes = kWays * sizeof(uint64_t);
+    size_t buckets = 1;
+    while(buckets * 2 * bucket_bytes <= std::max<size_t>(1, mb) << 20) buckets *= 2;
+    mask_ = buckets - 1;
+    slots_.reset(new std::atomic<uint64_t>[buckets * kWays]());
+}
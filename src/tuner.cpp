@@ -0,0 +1,186 @@
+#include "tuner.hpp"
+#include "solver.hpp"
+#include "state.hpp"
+#include "timing.hpp"
+#include <algorithm>
+#include <atomic>
+#include <ostream>
+#include <thread>
+
+namespace {
+struct Candidate {
+    SolverConfig cfg;
+    TuneScore score;
+    bool is_base = false;     // the config tune() started from
+};
+
+// Uniform in [lo, hi] on a 0.25 grid, so tuned files stay readable.
+float draw_weight(uint64_t& rng, float lo, float hi){
+    int steps = (int)((hi - lo) * 4.0f);
+    return lo + 0.25f * (float)(next_random(rng) % (uint64_t)(steps + 1));
+}
+
+int draw_int(uint64_t& rng, int lo, int hi){
+    return lo + (int)(next_random(rng) % (uint64_t)(hi - lo + 1));
+}
+
+SolverConfig random_candidate(const SolverConfig& base, uint64_t& rng){
+    SolverConfig c = base;
+    DualConfig& d = c.dual;
+    d.enabled = next_random(rng) & 1;
+    d.max_mrv_px = draw_int(rng, 2, 4);
+    d.min_depth = draw_int(rng, 0, 8);
+    d.max_depth = draw_int(rng, d.min_depth, 16);
+    d.require_flat_prop = next_random(rng) & 1;
+    d.max_py_candidates = draw_int(rng, 0, 3);
+    ScoringConfig& s = c.scoring;
+    s.influence = draw_weight(rng, -1.0f, 4.0f);
+    s.scarcity = draw_weight(rng, -3.0f, 1.0f);
+    s.shared_units = draw_weight(rng, 0.0f, 5.0f);
+    s.overlap = draw_weight(rng, 0.0f, 4.0f);
+    s.mrv = draw_weight(rng, -3.0f, 1.0f);
+    return c;
+}
+
+// Digit-order weights for every search, plus the dual activation window when
+// dual is on (the pressure-cell weights only matter then and keep the base's).
+std::vector<SolverConfig> grid_candidates(const SolverConfig& base){
+    static const float kInfluence[] = {1.0f, 2.0f, 3.0f};
+    static const float kScarcity[] = {-2.0f, -1.0f, 0.0f};
+    static const int kMinDepth[] = {2, 5};
+    static const int kMaxDepth[] = {8, 12};
+    std::vector<SolverConfig> out;
+    for(float inf : kInfluence){
+        for(float sc : kScarcity){
+            SolverConfig c = base;
+            c.scoring.influence = inf;
+            c.scoring.scarcity = sc;
+            c.dual.enabled = false;
+            out.push_back(c);
+            c.dual.enabled = true;
+            for(int lo : kMinDepth){
+                for(int hi : kMaxDepth){
+                    for(int flat = 0; flat < 2; ++flat){
+                        c.dual.min_depth = lo;
+                        c.dual.max_depth = hi;
+                        c.dual.require_flat_prop = flat != 0;
+                        out.push_back(c);
+                    }
+                }
+            }
+        }
+    }
+    return out;
+}
+
+TuneScore evaluate(const SolverConfig& cfg, const std::vector<BatchPuzzle>& puzzles, size_t n){
+    SudokuSolver solver(cfg);
+    TuneScore s;
+    const uint64_t cpu0 = timing::thread_cpu_ns();
+    for(size_t i = 0; i < n; ++i){
+        const BatchPuzzle& p = puzzles[i];
+        if(p.packed) solver.solve_packed(p.packed);
+        else solver.solve(p.text);
+        s.nodes += solver.nodes();
+        if(solver.result() == SolveResult::Timeout) ++s.timeouts;
+    }
+    s.cpu_ms = (double)(timing::thread_cpu_ns() - cpu0) / 1e6;
+    s.puzzles = n;
+    return s;
+}
+
+// Score every candidate on the first n puzzles, `threads` at a time.
+void evaluate_all(std::vector<Candidate>& cands, const std::vector<BatchPuzzle>& puzzles,
+                  size_t n, int threads){
+    std::atomic<size_t> next{0};
+    auto worker = [&]{
+        for(size_t i; (i = next.fetch_add(1, std::memory_order_relaxed)) < cands.size();)
+            cands[i].score = evaluate(cands[i].cfg, puzzles, n);
+    };
+    threads = (int)std::min<size_t>((size_t)threads, cands.size());
+    std::vector<std::thread> pool;
+    pool.reserve(threads);
+    for(int t = 0; t < threads; ++t) pool.emplace_back(worker);
+    for(auto& th : pool) th.join();
+}
+
+bool better(const TuneScore& a, const TuneScore& b, TuneObjective obj){
+    if(a.timeouts != b.timeouts) return a.timeouts < b.timeouts;
+    if(obj == TuneObjective::Time){
+        if(a.cpu_ms != b.cpu_ms) return a.cpu_ms < b.cpu_ms;
+        return a.nodes < b.nodes;
+    }
+    if(a.nodes != b.nodes) return a.nodes < b.nodes;
+    return a.cpu_ms < b.cpu_ms;
+}
+
+void log_round(std::ostream* log, int round, size_t cands, size_t puzzles, const Candidate& best){
+    if(!log) return;
+    *log << "tune round=" << round << " candidates=" << cands << " puzzles=" << puzzles
+         << " best_nodes=" << best.score.nodes << " best_cpu_ms=" << best.score.cpu_ms
+         << " best_timeouts=" << best.score.timeouts << "\n";
+}
+} // namespace
+
+TuneResult tune(const std::vector<BatchPuzzle>& puzzles, const SolverConfig& base, const TuneOptions& opt){
+    int threads = opt.threads;
+    if(threads <= 0) threads = (int)std::max(1u, std::thread::hardware_concurrency());
+    // Candidates are the unit of parallelism: keep each solve sequential.
+    SolverConfig seed_cfg = base;
+    seed_cfg.parallel.threads = 1;
+    seed_cfg.portfolio = false;
+    seed_cfg.cache_entries = 0;
+
+    std::vector<Candidate> cands;
+    cands.push_back(Candidate{seed_cfg, {}, true});
+    if(opt.method == TuneMethod::Grid){
+        for(const SolverConfig& c : grid_candidates(seed_cfg)) cands.push_back(Candidate{c, {}});
+    }else{
+        uint64_t rng = opt.seed ? opt.seed : 1;
+        for(size_t i = 1; i < std::max<size_t>(1, opt.trials); ++i)
+            cands.push_back(Candidate{random_candidate(seed_cfg, rng), {}});
+    }
+
+    TuneResult res;
+    const uint64_t wall_start = timing::mono_ns();
+    auto by_score = [&](const Candidate& a, const Candidate& b){ return better(a.score, b.score, opt.objective); };
+
+    size_t n = puzzles.size();
+    int rounds = 1;
+    if(opt.method == TuneMethod::Halving){
+        // Halve until one is left; the last round sees every puzzle.
+        for(size_t k = cands.size(); k > 1; k = (k + 1) / 2) ++rounds;
+        if(rounds > 1) --rounds;
+        n = std::max<size_t>(1, puzzles.size() >> (rounds - 1));
+    }
+    for(int round = 0; round < rounds; ++round){
+        n = round + 1 == rounds ? puzzles.size() : std::min(n, puzzles.size());
+        evaluate_all(cands, puzzles, n, threads);
+        res.evaluated += cands.size();
+        // Stable, so the base config wins ties.
+        std::stable_sort(cands.begin(), cands.end(), by_score);
+        log_round(opt.log, round, cands.size(), n, cands.front());
+        if(round + 1 < rounds){
+            // The base always moves on, so the last round can compare against it.
+            const size_t keep = (cands.size() + 1) / 2;
+            auto base_it = std::find_if(cands.begin(), cands.end(),
+                                        [](const Candidate& c){ return c.is_base; });
+            if(base_it - cands.begin() >= (ptrdiff_t)keep) std::iter_swap(base_it, cands.begin() + (keep - 1));
+            cands.resize(keep);
+            n *= 2;
+        }
+    }
+    const Candidate& base_cand = *std::find_if(cands.begin(), cands.end(),
+                                               [](const Candidate& c){ return c.is_base; });
+    res.baseline = base_cand.score;
+    // Ties and anything the sort ranked above the base still have to beat it.
+    const Candidate& winner = better(cands.front().score, res.baseline, opt.objective)
+                            ? cands.front() : base_cand;
+    res.best = winner.cfg;
+    res.best_score = winner.score;
+    res.best.parallel = base.parallel;
+    res.best.portfolio = base.portfolio;
+    res.best.cache_entries = base.cache_entries;
+    res.wall_ms = (double)(timing::mono_ns() - wall_start) / 1e6;
+    return res;
+}